@@ -0,0 +1,51 @@
+#pragma once
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+
+// Passes every allocation through to upstream and keeps count of them
+// Not thread safe, it is meant to sit under a single EventBus
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	explicit CountingResource(std::pmr::memory_resource* upstream) : _upstream(upstream) {};
+
+	CountingResource(const CountingResource&) = delete;
+	CountingResource& operator=(const CountingResource&) = delete;
+
+	__forceinline std::pmr::memory_resource* upstream() const { return _upstream; }
+	__forceinline std::size_t allocations() const { return _allocations; }
+	__forceinline std::size_t deallocations() const { return _deallocations; }
+	__forceinline std::size_t bytesInUse() const { return _bytesInUse; }
+	__forceinline std::size_t peakBytesInUse() const { return _peakBytesInUse; }
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		void* memory = _upstream->allocate(bytes, alignment);
+		_allocations++;
+		_bytesInUse += bytes;
+		_peakBytesInUse = std::max(_peakBytesInUse, _bytesInUse);
+		return memory;
+	}
+
+	void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override
+	{
+		_upstream->deallocate(memory, bytes, alignment);
+		_deallocations++;
+		_bytesInUse -= bytes;
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+private:
+	std::pmr::memory_resource* _upstream;
+
+	std::size_t _allocations = 0;
+	std::size_t _deallocations = 0;
+	std::size_t _bytesInUse = 0;
+	std::size_t _peakBytesInUse = 0;
+};
@@ -2,43 +2,239 @@
 
 
 
+EventBus::EventBus(std::pmr::memory_resource* resource, float spatialCellSize, std::size_t tickArenaBytes)
+    : _memory(std::pmr::polymorphic_allocator<Memory>(resource).new_object<Memory>(resource, tickArenaBytes)), _counter(&_memory->counter), _spatialCellSize(spatialCellSize),
+    _eventListeners(_counter), _positionalListeners(_counter), _positionalHandles(_counter),
+    _positionalHits(_counter), _pendingPositionalRemovals(_counter), _activeQueue(&_memory->tickQueueA)
+{
+    // Setting up the bus is not part of any tick
+    _allocationsAtLastTick = _counter->allocations();
+}
+
+// pmr containers keep their resource when move constructed so everything still points into _memory
+EventBus::EventBus(EventBus&& other) noexcept
+    : _memory(std::move(other._memory)), _counter(std::exchange(other._counter, nullptr)), _spatialCellSize(other._spatialCellSize),
+    _eventListeners(std::move(other._eventListeners)), _positionalListeners(std::move(other._positionalListeners)), _positionalHandles(std::move(other._positionalHandles)),
+    _nextPositionalHandle(other._nextPositionalHandle), _positionalHits(std::move(other._positionalHits)),
+    _positionalDispatchDepth(other._positionalDispatchDepth), _pendingPositionalRemovals(std::move(other._pendingPositionalRemovals)),
+    _activeQueue(std::exchange(other._activeQueue, nullptr)),
+    _ticks(other._ticks), _ticksThatAllocated(other._ticksThatAllocated), _lastTickAllocations(other._lastTickAllocations), _allocationsAtLastTick(other._allocationsAtLastTick)
+{
+}
+
+EventBus& EventBus::operator=(EventBus&& other) noexcept
+{
+    // Move assigning a pmr container cant change which resource it uses, so rebuild the whole bus around the others memory instead
+    if (this != &other)
+    {
+        this->~EventBus();
+        new (this) EventBus(std::move(other));
+    }
+    return *this;
+}
+
+void EventBus::MemoryDeleter::operator()(Memory* memory) const
+{
+    std::pmr::polymorphic_allocator<Memory>(memory->counter.upstream()).delete_object(memory);
+}
+
 // Overloaded version of addEventListener for functions without a Class
-void EventBus::addEventListener(std::function<void()> function, std::string eventName, bool loop)
+void EventBus::addEventListener(std::function<void()> function, std::string_view eventName, bool loop)
 {
-    auto Wrapper = [function]() { function(); };
-    auto emd = eventMetaData(Wrapper, loop);
-    _eventListeners.insert({ eventName, emd });
+    pushBackEventListener(eventName, EventCallback(std::move(function), _counter), loop);
 }
 
 // Process all events waiting in the event queue
 void EventBus::tick()
 {
-    // Iterate over each eventName in _allWaitingEvents
-    for (auto& eventName : _allWaitingEvents)
+    // Swap queues first so listeners can fire more events for next tick without touching the one being walked
+    TickQueue& processing = *_activeQueue;
+    _activeQueue = _activeQueue == &_memory->tickQueueA ? &_memory->tickQueueB : &_memory->tickQueueA;
+
+    // Iterate over each event waiting in the queue, in the order they were fired
+    for (auto& event : processing.events)
+    {
+        // Search for the event in the listeners and fire it if found
+        if (event.positional)
+        {
+            searchForPositionalEventAndFire(event.index, event.origin, event.radius);
+        }
+        else
+        {
+            searchForEventAndFire(event.index);
+        }
+    }
+
+    // Everything that was queued goes away in one go
+    processing.reset();
+
+    _ticks++;
+    _lastTickAllocations = _counter->allocations() - _allocationsAtLastTick;
+    _allocationsAtLastTick = _counter->allocations();
+    if (_lastTickAllocations > 0)
+    {
+        _ticksThatAllocated++;
+    }
+}
+
+void EventBus::trimSpatialGrids()
+{
+    for (auto& [eventName, positionalData] : _positionalListeners)
     {
-        // Search for the eventName in _eventListeners and fire the event if found
-        searchForEventAndFire(eventName);
+        positionalData.grid.trim();
     }
+}
 
-    // Clear the _allWaitingEvents vector
-    _allWaitingEvents.clear();
-    _allWaitingEvents.resize(0);
+EventBus::AllocationReport EventBus::allocationReport() const
+{
+    AllocationReport report;
+    report.allocations = _counter->allocations();
+    report.deallocations = _counter->deallocations();
+    report.bytesInUse = _counter->bytesInUse();
+    report.peakBytesInUse = _counter->peakBytesInUse();
+    report.ticks = _ticks;
+    report.ticksThatAllocated = _ticksThatAllocated;
+    report.lastTickAllocations = _lastTickAllocations;
+    return report;
 }
 
+void EventBus::printAllocationReport(std::ostream& stream) const
+{
+    AllocationReport report = allocationReport();
 
-void EventBus::pushBackEventListener(DataPack dataPair)
+    stream << "EventBus allocations: " << report.allocations << " (" << report.deallocations << " freed)\n";
+    stream << "  bytes in use: " << report.bytesInUse << ", peak: " << report.peakBytesInUse << "\n";
+    stream << "  ticks: " << report.ticks << ", ticks that allocated: " << report.ticksThatAllocated
+        << ", last tick allocations: " << report.lastTickAllocations << "\n";
+}
+
+std::size_t EventBus::addPositionalListener(std::function<void()> function, std::string_view eventName, FVec2 position, float radius, bool loop)
 {
-    auto location = _eventListeners.find(dataPair.index);
-    if (location == _eventListeners.end())
+    return pushBackPositionalListener(eventName, EventCallback(std::move(function), _counter), position, radius, loop);
+}
+
+std::size_t EventBus::pushBackPositionalListener(std::string_view eventName, EventCallback callback, FVec2 position, float radius, bool loop)
+{
+    std::size_t handle = _nextPositionalHandle++;
+
+    auto location = _positionalListeners.find(eventName);
+    if (location == _positionalListeners.end())
     {
-        _eventListeners.insert({ dataPair.index, eventMetaData(dataPair.functPair.second, dataPair.functPair.first)});
+        location = _positionalListeners.emplace(std::piecewise_construct, std::forward_as_tuple(eventName), std::forward_as_tuple(_spatialCellSize, _counter)).first;
+    }
+
+    location->second.grid.insert(handle, position, radius);
+    location->second.functionList.emplace(handle, std::pair<bool, EventCallback>(loop, std::move(callback)));
+    _positionalHandles.emplace(handle, location->first);
+
+    return handle;
+}
+
+bool EventBus::movePositionalListener(std::size_t handle, FVec2 position)
+{
+    auto owner = _positionalHandles.find(handle);
+    if (owner == _positionalHandles.end())
+        return false;
+
+    return _positionalListeners.find(owner->second)->second.grid.move(handle, position);
+}
+
+bool EventBus::removePositionalListener(std::size_t handle)
+{
+    auto owner = _positionalHandles.find(handle);
+    if (owner == _positionalHandles.end())
+        return false;
+
+    auto location = _positionalListeners.find(owner->second);
+    location->second.grid.remove(handle);
+
+    // The function might be the one running right now so only drop it once dispatch has finished
+    if (_positionalDispatchDepth > 0)
+    {
+        _pendingPositionalRemovals.emplace_back(owner->second, handle);
     }
     else
     {
-        // Current Event Data
-        auto& CED = _eventListeners.at(dataPair.index);
+        erasePositionalFunction(owner->second, handle);
+    }
+
+    _positionalHandles.erase(owner);
+    return true;
+}
 
-        CED.addFunct(dataPair.functPair);
+void EventBus::erasePositionalFunction(std::string_view eventName, std::size_t handle)
+{
+    auto location = _positionalListeners.find(eventName);
+    if (location == _positionalListeners.end())
+        return;
+
+    location->second.functionList.erase(handle);
 
+    if (location->second.functionList.empty())
+    {
+        _positionalListeners.erase(location);
     }
-}
\ No newline at end of file
+}
+
+void EventBus::searchForPositionalEventAndFire(std::string_view eventName, FVec2 origin, float radius)
+{
+    auto location = _positionalListeners.find(eventName);
+    if (location == _positionalListeners.end())
+        return;
+
+    // Nothing gets erased from _positionalListeners while dispatching so this reference stays valid
+    auto& positionalData = location->second;
+
+    // Collect the hits before calling anything since listeners are free to add, move or remove listeners
+    // A listener firing a forced positional event would reuse _positionalHits so take it for the duration
+    std::pmr::vector<std::size_t> hits(_counter);
+    hits.swap(_positionalHits);
+    hits.clear();
+    positionalData.grid.query(origin, radius, hits);
+
+    _positionalDispatchDepth++;
+
+    for (std::size_t handle : hits)
+    {
+        // An earlier listener may have removed this one
+        if (_positionalHandles.find(handle) == _positionalHandles.end())
+            continue;
+
+        auto& functData = positionalData.functionList.at(handle);
+
+        // If the function is marked as non-looping, remove it before it runs so it cant be hit twice
+        if (functData.first == false)
+        {
+            removePositionalListener(handle);
+        }
+
+        functData.second();
+    }
+
+    _positionalDispatchDepth--;
+
+    if (_positionalDispatchDepth == 0)
+    {
+        for (auto& [pendingEvent, pendingHandle] : _pendingPositionalRemovals)
+        {
+            erasePositionalFunction(pendingEvent, pendingHandle);
+        }
+        _pendingPositionalRemovals.clear();
+    }
+
+    _positionalHits.swap(hits);
+}
+
+void EventBus::pushBackEventListener(std::string_view eventName, EventCallback callback, bool loop)
+{
+    auto location = _eventListeners.find(eventName);
+    if (location == _eventListeners.end())
+    {
+        location = _eventListeners.emplace(std::piecewise_construct, std::forward_as_tuple(eventName), std::forward_as_tuple(_counter)).first;
+    }
+
+    // Current Event Data
+    auto& CED = location->second;
+
+    CED.addFunct(std::move(callback), loop);
+}
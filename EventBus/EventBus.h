@@ -2,152 +2,306 @@
 #include <functional>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <new>
+#include "SpatialGrid.h"
+#include "EventCallback.h"
+#include "CountingResource.h"
 
 class EventBus
 {
 public:
-	EventBus() {};
+	EventBus() : EventBus(std::pmr::get_default_resource()) {};
+
+	// spatialCellSize is the grid cell size used to find positional listeners, roughly the usual event radius works well
+	explicit EventBus(float spatialCellSize) : EventBus(std::pmr::get_default_resource(), spatialCellSize) {};
+
+	// Every container, key and callback the bus owns is allocated from resource
+	// Queued events live in one of two tickArenaBytes arenas (also taken from resource) that are reset every tick
+	explicit EventBus(std::pmr::memory_resource* resource, float spatialCellSize = 32.0f, std::size_t tickArenaBytes = 16 * 1024);
+
+	// Moving keeps every listener, handle and queued event, a moved from bus can only be destroyed or assigned to
+	EventBus(EventBus&& other) noexcept;
+	EventBus& operator=(EventBus&& other) noexcept;
+
+	// A copy would need every callback cloned into a second resource so copying isnt supported
+	EventBus(const EventBus&) = delete;
+	EventBus& operator=(const EventBus&) = delete;
 
 	// Add an event listener for a specific event name and function
 	template <typename ClassType>
-	void addEventListener(std::function<void(ClassType*)> function, ClassType* instance, std::string eventName, bool loop = false)
+	void addEventListener(std::function<void(ClassType*)> function, ClassType* instance, std::string_view eventName, bool loop = false)
 	{
 		auto Wrapper = [function = std::move(function), instance]() { function(instance); };
-		auto emd = eventMetaData(Wrapper, loop);
 
-
-		pushBackEventListener(DataPack(eventName, { loop, Wrapper }));
+		pushBackEventListener(eventName, EventCallback(std::move(Wrapper), _counter), loop);
 	}
 
 	// Overloaded version of addEventListener for functions in a class and with args
 	template <typename ClassType, typename ...Args>
-	void addEventListener(std::function<void(ClassType*, Args...)> function, ClassType* instance, std::string eventName, Args... args, bool loop = false)
+	void addEventListener(std::function<void(ClassType*, Args...)> function, ClassType* instance, std::string_view eventName, Args... args, bool loop = false)
 	{
-		auto Wrapper = [function = std::move(function), instance, args]() { function(instance, args...); };
-		auto emd = eventMetaData(Wrapper, loop);
-
+		auto Wrapper = [function = std::move(function), instance, args...]() { function(instance, args...); };
 
-		pushBackEventListener(DataPack(eventName, { loop, Wrapper }));
+		pushBackEventListener(eventName, EventCallback(std::move(Wrapper), _counter), loop);
 	}
 
 
 	// Overloaded version to add an event listener with variable arguments
 	template <typename ...Args>
-	void addEventListener(std::function<void(Args...)> function, std::string eventName, Args... args, bool loop = false)
+	void addEventListener(std::function<void(Args...)> function, std::string_view eventName, Args... args, bool loop = false)
 	{
 		// Define a lambda function Wrapper that captures function and args and calls function with args when invoked
-		auto Wrapper = [function = std::move(function), args]() { function(args...); };
-
-		// Create an eventMetaData object emd with the Wrapper lambda function and the loop parameter
-		auto emd = eventMetaData(Wrapper, loop);
+		auto Wrapper = [function = std::move(function), args...]() { function(args...); };
 
-		pushBackEventListener(DataPack(eventName, { loop, Wrapper }));
+		// The Wrapper is stored in memory from the bus resource rather than the global heap
+		pushBackEventListener(eventName, EventCallback(std::move(Wrapper), _counter), loop);
 	}
 
 	// Overloaded version of addEventListener for functions without a Class
-	void addEventListener(std::function<void()> function, std::string eventName, bool loop = false);
+	void addEventListener(std::function<void()> function, std::string_view eventName, bool loop = false);
+
+	// Takes any callable (lambdas and so on) and stores it straight in bus memory
+	// The std::function overloads above still work but a capturing lambda passed to them gets its captures put on the global heap first
+	template <typename Function, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Function>&>>>
+	void addEventListener(Function&& function, std::string_view eventName, bool loop = false)
+	{
+		pushBackEventListener(eventName, EventCallback(std::forward<Function>(function), _counter), loop);
+	}
+
+	// Callable version for functions that take the class instance
+	template <typename ClassType, typename Function, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Function>&, ClassType*>>>
+	void addEventListener(Function&& function, ClassType* instance, std::string_view eventName, bool loop = false)
+	{
+		auto Wrapper = [function = std::forward<Function>(function), instance]() mutable { function(instance); };
+
+		pushBackEventListener(eventName, EventCallback(std::move(Wrapper), _counter), loop);
+	}
 
 	// Fire an event by its name
-	__forceinline void fireEvent(std::string eventName)
+	__forceinline void fireEvent(std::string_view eventName)
 	{
-		_allWaitingEvents.push_back(eventName);
+		_activeQueue->events.emplace_back(eventName);
 	}
 
 	// Forcefully fire an event without waiting in the event queue
 	// Should be used sparingly and with caution
-	__forceinline void fireEventForce(std::string eventName)
+	__forceinline void fireEventForce(std::string_view eventName)
 	{
 		searchForEventAndFire(eventName);
 	}
 
-	// Process all events waiting in the event queue
+	// Add a listener that only hears fireEventAt events whose circle overlaps the circle at position with radius
+	// Returns a handle for movePositionalListener and removePositionalListener
+	std::size_t addPositionalListener(std::function<void()> function, std::string_view eventName, FVec2 position, float radius, bool loop = false);
+
+	// Overloaded version of addPositionalListener for functions in a class
+	template <typename ClassType>
+	std::size_t addPositionalListener(std::function<void(ClassType*)> function, ClassType* instance, std::string_view eventName, FVec2 position, float radius, bool loop = false)
+	{
+		auto Wrapper = [function = std::move(function), instance]() { function(instance); };
+
+		return pushBackPositionalListener(eventName, EventCallback(std::move(Wrapper), _counter), position, radius, loop);
+	}
+
+	// Callable versions of addPositionalListener, same as the callable addEventListener ones
+	template <typename Function, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Function>&>>>
+	std::size_t addPositionalListener(Function&& function, std::string_view eventName, FVec2 position, float radius, bool loop = false)
+	{
+		return pushBackPositionalListener(eventName, EventCallback(std::forward<Function>(function), _counter), position, radius, loop);
+	}
+
+	template <typename ClassType, typename Function, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Function>&, ClassType*>>>
+	std::size_t addPositionalListener(Function&& function, ClassType* instance, std::string_view eventName, FVec2 position, float radius, bool loop = false)
+	{
+		auto Wrapper = [function = std::forward<Function>(function), instance]() mutable { function(instance); };
+
+		return pushBackPositionalListener(eventName, EventCallback(std::move(Wrapper), _counter), position, radius, loop);
+	}
+
+	// Move a positional listener, returns false if the handle is not listening anymore
+	bool movePositionalListener(std::size_t handle, FVec2 position);
+
+	// Stop a positional listener, returns false if the handle is not listening anymore
+	bool removePositionalListener(std::size_t handle);
+
+	// Fire an event at a point, only the positional listeners for eventName within reach are called
+	// Listeners added with addEventListener do not hear these, it waits in the same queue as fireEvent so order is kept
+	__forceinline void fireEventAt(std::string_view eventName, FVec2 origin, float radius)
+	{
+		_activeQueue->events.emplace_back(eventName, origin, radius);
+	}
+
+	// Forcefully fire a positional event without waiting in the event queue
+	// Should be used sparingly and with caution
+	__forceinline void fireEventAtForce(std::string_view eventName, FVec2 origin, float radius)
+	{
+		searchForPositionalEventAndFire(eventName, origin, radius);
+	}
+
+	// Process all events waiting in the event queue, fireEvent and fireEventAt events run in the order they were fired
+	// Events fired while this runs are queued for the next tick
 	void tick();
 
+	// Frees the grid cells positional listeners have left, call it after a big move or between levels
+	// Each grid keeps up to SpatialGrid::maxEmptyCells of them so moving listeners dont allocate every tick
+	void trimSpatialGrids();
+
+	// What the bus has asked its memory resource for
+	struct AllocationReport
+	{
+		std::size_t allocations = 0;
+		std::size_t deallocations = 0;
+		std::size_t bytesInUse = 0;
+		std::size_t peakBytesInUse = 0;
+
+		std::size_t ticks = 0;
+
+		// Ticks where anything was allocated between the end of the previous tick and the end of that one
+		std::size_t ticksThatAllocated = 0;
+
+		// Allocations between the end of the previous tick and the end of the most recent one
+		// This is 0 for a tick that adds no listeners, fits in its arena and only moves positional listeners into grid cells that have been used before
+		// Only the last SpatialGrid::maxEmptyCells cells per event name count as used before, and trimSpatialGrids() forgets them all
+		std::size_t lastTickAllocations = 0;
+	};
+
+	AllocationReport allocationReport() const;
+
+	void printAllocationReport(std::ostream& stream = std::cout) const;
+
 public:
 
+	// Lets the string keyed maps be searched with a std::string_view without building a string first
+	struct StringHash
+	{
+		using is_transparent = void;
+
+		__forceinline std::size_t operator()(std::string_view value) const
+		{
+			return std::hash<std::string_view>{}(value);
+		}
+	};
+
 	// Inner class to store event metadata
 	class eventMetaData
 	{
 	public:
-		// Constructor that adds a function to the functionList with an associated loop flag
-		eventMetaData(std::function<void()> func, bool loop)
-		{
-			functionList.insert({ index, { loop, func } });
-			index++;
-		}
+		eventMetaData(std::pmr::memory_resource* resource) : functionList(resource) {};
 
 		// Calls all the functions in the functionList and handles removal of functions marked as non-looping
 		inline bool callAllFunctions()
 		{
-			// Iterate over the functionList using structured binding
-			for (auto& [HashedIndex, functData] : functionList)
+			for (auto iterator = functionList.begin(); iterator != functionList.end();)
 			{
+				auto& functData = iterator->second;
+
 				// Invoke the stored function
 				functData.second();
 
 				// If the function is marked as non-looping, remove it from the functionList
 				if (functData.first == false)
 				{
-					functionList.erase(HashedIndex);
+					iterator = functionList.erase(iterator);
+				}
+				else
+				{
+					++iterator;
 				}
-			}
-
-			// Rehash the functionList to optimize its internal structure
-			functionList.rehash(functionList.size());
-
-			// Handle the case when all functions have been removed
-			if (functionList.empty())
-			{
-				return false;
 			}
 
 			// Return true if there are remaining functions in the functionList
-			return true;
+			return !functionList.empty();
 		}
 
-		__forceinline void addFunct(std::function<void()> func, bool loop)
+		__forceinline void addFunct(EventCallback func, bool loop)
 		{
-
-			functionList.insert({ index, { loop, func } });
+			functionList.emplace(index, std::pair<bool, EventCallback>(loop, std::move(func)));
 			index++;
 		}
 
+	private:
+		std::size_t index = 0;
 
-		__forceinline void addFunct(std::pair<bool, std::function<void()>> data)
-		{
-
-			functionList.insert({ index, data });
-			index++;
-		}
+		std::pmr::unordered_map<std::size_t, std::pair<bool, EventCallback>> functionList;
+	};
 
+	// One fireEvent or fireEventAt waiting for tick(), both kinds share a queue so they run in the order they were fired
+	class QueuedEvent
+	{
 	public:
+		// Lets pmr containers hand their allocator down to index
+		using allocator_type = std::pmr::polymorphic_allocator<char>;
 
-	private:
-		std::size_t index = 0;
+		QueuedEvent(std::string_view Index, const allocator_type& allocator = {}) : index(Index, allocator), origin(), radius(0.0f), positional(false) {};
+		QueuedEvent(std::string_view Index, FVec2 Origin, float Radius, const allocator_type& allocator = {}) : index(Index, allocator), origin(Origin), radius(Radius), positional(true) {};
+		QueuedEvent(const QueuedEvent& other, const allocator_type& allocator) : index(other.index, allocator), origin(other.origin), radius(other.radius), positional(other.positional) {};
+		QueuedEvent(QueuedEvent&& other, const allocator_type& allocator) : index(std::move(other.index), allocator), origin(other.origin), radius(other.radius), positional(other.positional) {};
+		QueuedEvent(const QueuedEvent& other) = default;
+		QueuedEvent(QueuedEvent&& other) = default;
+		QueuedEvent& operator=(const QueuedEvent& other) = default;
+		QueuedEvent& operator=(QueuedEvent&& other) = default;
+
+		std::pmr::string index;
+
+		// Only used when positional is set
+		FVec2 origin;
 
-		std::unordered_map<std::size_t, std::pair<bool, std::function<void()>>> functionList;
+		float radius;
+
+		bool positional;
 	};
 
+	// All positional listeners for one event name plus the grid that finds them
+	class positionalMetaData
+	{
+	public:
+		positionalMetaData(float cellSize, std::pmr::memory_resource* resource) : grid(cellSize, resource), functionList(resource) {};
+
+		SpatialGrid grid;
 
+		// Keyed by listener handle, same loop flag and function pair as eventMetaData
+		std::pmr::unordered_map<std::size_t, std::pair<bool, EventCallback>> functionList;
+	};
 
-	class DataPack
+	// Events queued for one tick, everything in here comes out of a monotonic arena that gets reset in one go
+	class TickQueue
 	{
 	public:
-		DataPack(std::string Index, std::pair<bool, std::function<void()>> functs): index(Index), functPair(functs) {};
+		TickQueue(std::size_t arenaBytes, std::pmr::memory_resource* upstream)
+			: _buffer(arenaBytes > 0 ? arenaBytes : 1, upstream), _arena(_buffer.data(), _buffer.size(), upstream), events(&_arena) {};
 
-		std::string index;
+		TickQueue(const TickQueue&) = delete;
+		TickQueue& operator=(const TickQueue&) = delete;
 
-		std::pair<bool, std::function<void()>> functPair;
+		// Drops everything queued and rewinds the arena back to the start of its buffer
+		void reset()
+		{
+			std::pmr::vector<QueuedEvent>(&_arena).swap(events);
+			_arena.release();
+		}
 
+	private:
+		// Declared first so it outlives the arena and the containers using it
+		std::pmr::vector<std::byte> _buffer;
+		std::pmr::monotonic_buffer_resource _arena;
+
+	public:
+		std::pmr::vector<QueuedEvent> events;
 	};
 
 private:
 
-	void pushBackEventListener(DataPack dataPair);
-	__forceinline void searchForEventAndFire(std::string eventName)
+	void pushBackEventListener(std::string_view eventName, EventCallback callback, bool loop);
+	std::size_t pushBackPositionalListener(std::string_view eventName, EventCallback callback, FVec2 position, float radius, bool loop);
+
+	__forceinline void searchForEventAndFire(std::string_view eventName)
 	{
 		// Search for the eventName in the _eventListeners unordered_map
 		auto hashMapOperator = _eventListeners.find(eventName);
@@ -163,20 +317,70 @@ private:
 		// Invoke the stored function in the eventMetaData
 		if (!eventMetaData.callAllFunctions())
 		{
-			_eventListeners.erase(eventName);
+			// A listener may have added a new event name and rehashed _eventListeners so look it up again
+			hashMapOperator = _eventListeners.find(eventName);
+			if (hashMapOperator != _eventListeners.end())
+			{
+				_eventListeners.erase(hashMapOperator);
+			}
 		}
 
 		// Return from the function
 		return;
 	}
 
+	void searchForPositionalEventAndFire(std::string_view eventName, FVec2 origin, float radius);
+	void erasePositionalFunction(std::string_view eventName, std::size_t handle);
+
 private:
 
+	// The counter and the tick queues are pointed at by the containers so they live in their own block taken from the
+	// resource the bus was given, that way they keep their address when the bus is moved
+	class Memory
+	{
+	public:
+		Memory(std::pmr::memory_resource* upstream, std::size_t tickArenaBytes) : counter(upstream), tickQueueA(tickArenaBytes, &counter), tickQueueB(tickArenaBytes, &counter) {};
+
+		// Sits between the bus and the resource it was given so allocationReport() can count
+		CountingResource counter;
+
+		// Two queues so events fired during a tick land in the one that is not being processed
+		TickQueue tickQueueA;
+		TickQueue tickQueueB;
+	};
+
+	struct MemoryDeleter
+	{
+		void operator()(Memory* memory) const;
+	};
+
+	// Declared first so it outlives everything allocated from it
+	std::unique_ptr<Memory, MemoryDeleter> _memory;
+	CountingResource* _counter;
+
+	float _spatialCellSize = 32.0f;
 
 	// A map to store event listeners, where the key is the event name and the value is the metadata
-	std::unordered_map<std::string, eventMetaData> _eventListeners;
+	std::pmr::unordered_map<std::pmr::string, eventMetaData, StringHash, std::equal_to<>> _eventListeners;
 
-	// A vector to store events waiting to be processed
-	std::vector<std::string> _allWaitingEvents;
-};
+	// Positional listeners by event name, and which event name each handle belongs to
+	std::pmr::unordered_map<std::pmr::string, positionalMetaData, StringHash, std::equal_to<>> _positionalListeners;
+	std::pmr::unordered_map<std::size_t, std::pmr::string> _positionalHandles;
+	std::size_t _nextPositionalHandle = 0;
+
+	// Scratch list of the handles an event reached, kept around so firing does not allocate every time
+	std::pmr::vector<std::size_t> _positionalHits;
 
+	// Removals asked for while positional listeners are being called, applied once the outermost dispatch ends
+	std::size_t _positionalDispatchDepth = 0;
+	std::pmr::vector<std::pair<std::pmr::string, std::size_t>> _pendingPositionalRemovals;
+
+	// Either _memory->tickQueueA or _memory->tickQueueB
+	TickQueue* _activeQueue;
+
+	// Bookkeeping for allocationReport()
+	std::size_t _ticks = 0;
+	std::size_t _ticksThatAllocated = 0;
+	std::size_t _lastTickAllocations = 0;
+	std::size_t _allocationsAtLastTick = 0;
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+// Type erased void() callable, like std::function<void()> except the callable always lives in memory
+// taken from a std::pmr::memory_resource instead of the global heap
+class EventCallback
+{
+public:
+	EventCallback() {};
+
+	template <typename Function, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Function>, EventCallback>>>
+	EventCallback(Function&& function, std::pmr::memory_resource* resource) : _resource(resource)
+	{
+		using ModelType = Model<std::decay_t<Function>>;
+		void* memory = _resource->allocate(sizeof(ModelType), alignof(ModelType));
+		_callable = new (memory) ModelType(std::forward<Function>(function));
+	}
+
+	// Copies allocate from the same resource as the original
+	EventCallback(const EventCallback& other) : _resource(other._resource)
+	{
+		if (other._callable)
+			_callable = other._callable->clone(_resource);
+	}
+
+	EventCallback(EventCallback&& other) noexcept : _callable(other._callable), _resource(other._resource)
+	{
+		other._callable = nullptr;
+	}
+
+	EventCallback& operator=(EventCallback other) noexcept
+	{
+		std::swap(_callable, other._callable);
+		std::swap(_resource, other._resource);
+		return *this;
+	}
+
+	~EventCallback()
+	{
+		reset();
+	}
+
+	void reset()
+	{
+		if (_callable)
+		{
+			_callable->destroy(_resource);
+			_callable = nullptr;
+		}
+	}
+
+	__forceinline void operator()() const
+	{
+		_callable->call();
+	}
+
+	__forceinline explicit operator bool() const
+	{
+		return _callable != nullptr;
+	}
+
+private:
+	class Concept
+	{
+	public:
+		virtual ~Concept() {};
+		virtual void call() = 0;
+		virtual Concept* clone(std::pmr::memory_resource* resource) const = 0;
+		virtual void destroy(std::pmr::memory_resource* resource) = 0;
+	};
+
+	template <typename Function>
+	class Model final : public Concept
+	{
+	public:
+		template <typename Arg>
+		Model(Arg&& function) : _function(std::forward<Arg>(function)) {};
+
+		void call() override
+		{
+			_function();
+		}
+
+		Concept* clone(std::pmr::memory_resource* resource) const override
+		{
+			void* memory = resource->allocate(sizeof(Model), alignof(Model));
+			return new (memory) Model(_function);
+		}
+
+		// Destroys this and hands its memory back to the resource it came from
+		void destroy(std::pmr::memory_resource* resource) override
+		{
+			this->~Model();
+			resource->deallocate(this, sizeof(Model), alignof(Model));
+		}
+
+	private:
+		Function _function;
+	};
+
+private:
+	Concept* _callable = nullptr;
+	std::pmr::memory_resource* _resource = nullptr;
+};
@@ -0,0 +1,204 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+
+
+
+SpatialGrid::SpatialGrid(float cellSize, std::pmr::memory_resource* resource) : _cells(resource), _entries(resource), _oversized(resource)
+{
+    _cellSize = cellSize > 0 ? cellSize : 32.0f;
+    _inverseCellSize = 1.0f / _cellSize;
+}
+
+void SpatialGrid::insert(std::size_t id, FVec2 position, float radius)
+{
+    auto existing = _entries.find(id);
+    if (existing != _entries.end())
+    {
+        unlink(id, existing->second);
+        _entries.erase(existing);
+    }
+
+    Entry entry;
+    entry.position = position;
+    entry.radius = std::max(radius, 0.0f);
+    entry.cells = cellsFor(position, entry.radius);
+    entry.oversized = false;
+    entry.queryStamp = _queryStamp;
+
+    link(id, entry);
+    _entries.insert({ id, entry });
+}
+
+bool SpatialGrid::move(std::size_t id, FVec2 position)
+{
+    auto location = _entries.find(id);
+    if (location == _entries.end())
+        return false;
+
+    auto& entry = location->second;
+    CellRange cells = cellsFor(position, entry.radius);
+
+    // Most moves stay inside the same cells so only the position needs updating
+    if (!(cells == entry.cells))
+    {
+        unlink(id, entry);
+        entry.cells = cells;
+        link(id, entry);
+    }
+    entry.position = position;
+    return true;
+}
+
+bool SpatialGrid::remove(std::size_t id)
+{
+    auto location = _entries.find(id);
+    if (location == _entries.end())
+        return false;
+
+    unlink(id, location->second);
+    _entries.erase(location);
+    return true;
+}
+
+void SpatialGrid::query(FVec2 origin, float radius, std::pmr::vector<std::size_t>& out)
+{
+    radius = std::max(radius, 0.0f);
+    std::size_t first = out.size();
+    _queryStamp++;
+
+    auto Check = [&](std::size_t id, Entry& entry)
+    {
+        if (entry.queryStamp == _queryStamp)
+            return;
+        entry.queryStamp = _queryStamp;
+
+        float reach = radius + entry.radius;
+        if (entry.position.distanceSquared(origin) <= reach * reach)
+            out.push_back(id);
+    };
+
+    CellRange cells = cellsFor(origin, radius);
+
+    // Past this point walking the cells costs more than just checking every circle
+    if (cells.cellCount() > _entries.size())
+    {
+        for (auto& [id, entry] : _entries)
+            Check(id, entry);
+    }
+    else
+    {
+        for (int x = cells.minX; x <= cells.maxX; x++)
+        {
+            for (int y = cells.minY; y <= cells.maxY; y++)
+            {
+                auto cell = _cells.find(cellKey(x, y));
+                if (cell == _cells.end())
+                    continue;
+
+                for (std::size_t id : cell->second)
+                    Check(id, _entries.at(id));
+            }
+        }
+
+        for (std::size_t id : _oversized)
+            Check(id, _entries.at(id));
+    }
+
+    // Listeners get called in the order they were added no matter which cells they came from
+    std::sort(out.begin() + first, out.end());
+}
+
+void SpatialGrid::trim()
+{
+    for (auto cell = _cells.begin(); cell != _cells.end();)
+    {
+        if (cell->second.empty())
+        {
+            cell = _cells.erase(cell);
+        }
+        else
+        {
+            ++cell;
+        }
+    }
+    _emptyCells = 0;
+}
+
+SpatialGrid::CellRange SpatialGrid::cellsFor(FVec2 position, float radius) const
+{
+    return { cellCoord(position.x - radius), cellCoord(position.y - radius), cellCoord(position.x + radius), cellCoord(position.y + radius) };
+}
+
+int SpatialGrid::cellCoord(float value) const
+{
+    // Clamped so far away or non finite positions still land in a valid cell
+    double cell = std::floor((double)value * _inverseCellSize);
+    if (!(cell > -1073741824.0))
+        return -1073741824;
+    if (cell > 1073741823.0)
+        return 1073741823;
+    return (int)cell;
+}
+
+void SpatialGrid::link(std::size_t id, Entry& entry)
+{
+    entry.oversized = entry.cells.cellCount() > maxCellsPerEntry;
+    if (entry.oversized)
+    {
+        _oversized.push_back(id);
+        return;
+    }
+
+    for (int x = entry.cells.minX; x <= entry.cells.maxX; x++)
+    {
+        for (int y = entry.cells.minY; y <= entry.cells.maxY; y++)
+        {
+            auto [cell, inserted] = _cells.try_emplace(cellKey(x, y));
+            if (!inserted && cell->second.empty())
+                _emptyCells--;
+
+            cell->second.push_back(id);
+        }
+    }
+}
+
+void SpatialGrid::unlink(std::size_t id, const Entry& entry)
+{
+    if (entry.oversized)
+    {
+        _oversized.erase(std::find(_oversized.begin(), _oversized.end(), id));
+        return;
+    }
+
+    for (int x = entry.cells.minX; x <= entry.cells.maxX; x++)
+    {
+        for (int y = entry.cells.minY; y <= entry.cells.maxY; y++)
+        {
+            auto cell = _cells.find(cellKey(x, y));
+            if (cell == _cells.end())
+                continue;
+
+            // Order inside a cell does not matter so swap with the back instead of shifting
+            auto& ids = cell->second;
+            auto location = std::find(ids.begin(), ids.end(), id);
+            if (location != ids.end())
+            {
+                *location = ids.back();
+                ids.pop_back();
+            }
+
+            // Empty cells are kept so a listener moving back and forth across a cell edge doesnt allocate every time
+            if (ids.empty())
+            {
+                if (_emptyCells < maxEmptyCells)
+                {
+                    _emptyCells++;
+                }
+                else
+                {
+                    _cells.erase(cell);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <memory_resource>
+#include "../VectorBase/VecBase.h"
+
+// Uniform grid of circles keyed by id, used by EventBus to find the positional listeners an event reaches
+// Each circle is linked into every cell its bounding box touches so a query only has to look at the
+// cells around the query circle instead of every circle
+class SpatialGrid
+{
+public:
+	// All of the grids containers allocate from resource
+	explicit SpatialGrid(float cellSize = 32.0f, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	// Adds a circle, an id that is already in the grid just gets moved
+	void insert(std::size_t id, FVec2 position, float radius);
+
+	// Returns false if id is not in the grid
+	bool move(std::size_t id, FVec2 position);
+
+	// Returns false if id is not in the grid
+	bool remove(std::size_t id);
+
+	// Appends the id of every circle that overlaps the query circle to out, in ascending id order
+	void query(FVec2 origin, float radius, std::pmr::vector<std::size_t>& out);
+
+	__forceinline std::size_t size() const
+	{
+		return _entries.size();
+	}
+
+	__forceinline bool empty() const
+	{
+		return _entries.empty();
+	}
+
+	// Frees every cell that has no circles in it anymore, see maxEmptyCells
+	void trim();
+
+private:
+	struct CellRange
+	{
+		int minX, minY, maxX, maxY;
+
+		__forceinline bool operator==(const CellRange& other) const
+		{
+			return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+		}
+
+		// Done in 64 bit since an infinite radius spans the whole clamped range, which doesnt fit in an int
+		__forceinline std::uint64_t cellCount() const
+		{
+			return (std::uint64_t)((std::int64_t)maxX - minX + 1) * (std::uint64_t)((std::int64_t)maxY - minY + 1);
+		}
+	};
+
+	struct Entry
+	{
+		FVec2 position;
+		float radius;
+		CellRange cells;
+
+		// Set when the circle covers too many cells to link, those get checked on every query instead
+		bool oversized;
+
+		// Last query that already looked at this entry, stops circles in several cells being reported twice
+		std::size_t queryStamp;
+	};
+
+	CellRange cellsFor(FVec2 position, float radius) const;
+	int cellCoord(float value) const;
+
+	void link(std::size_t id, Entry& entry);
+	void unlink(std::size_t id, const Entry& entry);
+
+	__forceinline static std::uint64_t cellKey(int x, int y)
+	{
+		return ((std::uint64_t)(std::uint32_t)x << 32) | (std::uint32_t)y;
+	}
+
+	// Circles that would need more cells than this go on the oversized list instead
+	static constexpr std::size_t maxCellsPerEntry = 64;
+
+	// Cells that empty out are kept so moving across a cell edge and back doesnt allocate every time
+	// Past this many empty cells they get freed straight away instead so the grid cant keep growing
+	static constexpr std::size_t maxEmptyCells = 1024;
+
+private:
+	float _cellSize;
+	float _inverseCellSize;
+
+	std::pmr::unordered_map<std::uint64_t, std::pmr::vector<std::size_t>> _cells;
+	std::size_t _emptyCells = 0;
+	std::pmr::unordered_map<std::size_t, Entry> _entries;
+	std::pmr::vector<std::size_t> _oversized;
+
+	std::size_t _queryStamp = 0;
+};
@@ -0,0 +1,175 @@
+#include "ThreadPool.h"
+
+
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        std::size_t hardwareThreads = std::thread::hardware_concurrency();
+        // The calling thread also does work in parallelFor so leave a core for it
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    _workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; i++)
+    {
+        _workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        _stopping = true;
+    }
+    _jobSignal.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        _jobs.push_back(std::move(job));
+    }
+    _jobSignal.notify_one();
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& function)
+{
+    if (count == 0)
+        return;
+
+    // Nothing to share the work with so just run it here
+    if (count == 1 || _workers.empty())
+    {
+        for (std::size_t i = 0; i < count; i++)
+            function(i);
+        return;
+    }
+
+    // Shared so helpers that only get picked up after we return still have something valid to look at
+    struct ForState
+    {
+        std::atomic<std::size_t> nextIndex = 0;
+        std::atomic<std::size_t> remaining = 0;
+        std::mutex doneMutex;
+        std::condition_variable doneSignal;
+
+        // First exception thrown by function, rethrown on the calling thread once everyone has stopped
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<ForState>();
+    state->remaining = count;
+
+    auto Finish = [state](std::size_t done)
+    {
+        if (done != 0 && state->remaining.fetch_sub(done) == done)
+        {
+            std::lock_guard<std::mutex> lock(state->doneMutex);
+            state->doneSignal.notify_all();
+        }
+    };
+
+    // Every helper keeps grabbing indices until they run out so uneven chunks balance themselves
+    // A helper that starts late sees nextIndex >= count and never touches function
+    auto Worker = [state, count, &function, Finish]()
+    {
+        std::size_t index;
+        while ((index = state->nextIndex.fetch_add(1)) < count)
+        {
+            try
+            {
+                function(index);
+            }
+            catch (...)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(state->doneMutex);
+                    if (!state->error)
+                        state->error = std::current_exception();
+                }
+
+                // Stop handing out indices and count the ones nobody will run as done
+                std::size_t next = std::min(state->nextIndex.exchange(count), count);
+                Finish(count - next);
+            }
+            Finish(1);
+        }
+    };
+
+    std::size_t helpers = std::min(count - 1, _workers.size());
+    for (std::size_t i = 0; i < helpers; i++)
+    {
+        submit(Worker);
+    }
+
+    Worker();
+
+    // Help with other queued jobs (nested parallelFor calls) while the stragglers finish
+    while (state->remaining.load() != 0)
+    {
+        if (!runOneJob())
+        {
+            std::unique_lock<std::mutex> lock(state->doneMutex);
+            state->doneSignal.wait_for(lock, std::chrono::microseconds(100), [&]() { return state->remaining.load() == 0; });
+        }
+    }
+
+    // Taken out of state so the exception is released here and not by whichever helper drops state last
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(state->doneMutex);
+        error = std::move(state->error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+bool ThreadPool::runOneJob()
+{
+    std::function<void()> job;
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        if (_jobs.empty())
+            return false;
+
+        job = std::move(_jobs.front());
+        _jobs.pop_front();
+    }
+
+    job();
+    return true;
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_jobMutex);
+            _jobSignal.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+
+            if (_stopping && _jobs.empty())
+                return;
+
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        job();
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <chrono>
+#include <algorithm>
+#include <cstddef>
+
+class ThreadPool
+{
+public:
+	// Creates a pool with threadCount workers, 0 means one per hardware thread minus the caller
+	explicit ThreadPool(std::size_t threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// The process wide pool that the library code shares so we dont spin up threads per call
+	static ThreadPool& shared();
+
+	// Number of threads that can run work at the same time (workers plus the calling thread)
+	__forceinline std::size_t concurrency() const
+	{
+		return _workers.size() + 1;
+	}
+
+	// Queue a job to be ran on one of the workers
+	void submit(std::function<void()> job);
+
+	// Run function(index) for every index in [0, count) and block until all of them are done
+	// The calling thread helps out so nested calls from inside a job wont deadlock
+	// If function throws no more indices get started and the first exception is rethrown here once the rest have finished
+	void parallelFor(std::size_t count, const std::function<void(std::size_t)>& function);
+
+private:
+	// Pops and runs a single queued job, returns false if the queue was empty
+	bool runOneJob();
+
+	void workerLoop();
+
+private:
+	std::vector<std::thread> _workers;
+
+	// Jobs waiting for a free worker
+	std::deque<std::function<void()>> _jobs;
+
+	std::mutex _jobMutex;
+	std::condition_variable _jobSignal;
+	bool _stopping = false;
+};
@@ -0,0 +1,491 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <bit>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "VecBase.h"
+#include "VecSoA.h"
+#include "VecSimd.h"
+
+// Batch 2D geometry tests, one query against a whole VecSoA2 worth of candidates
+// With AVX2 the candidates are tested a full register at a time (8 for float, 4 for double) and
+// everything else goes through the same test written out as plain scalar code
+// Every test can either fill a HitMask or write the indices of the hits
+namespace VecGeometry
+{
+	// One bit per candidate, bit i lives in bits[i / 8] at (i % 8)
+	struct HitMask
+	{
+		std::vector<std::uint8_t> bits;
+		std::size_t size = 0;
+
+		void reset(std::size_t count)
+		{
+			size = count;
+			bits.assign((count + 7) / 8, 0);
+		}
+
+		__forceinline bool test(std::size_t index) const
+		{
+			return (bits[index / 8] >> (index % 8)) & 1;
+		}
+
+		std::size_t count() const
+		{
+			std::size_t total = 0;
+			for (std::uint8_t byte : bits)
+				total += std::popcount(byte);
+			return total;
+		}
+	};
+
+	namespace detail
+	{
+		class MaskSink
+		{
+		public:
+			MaskSink(HitMask& mask, std::size_t count) : _mask(mask)
+			{
+				_mask.reset(count);
+			}
+
+			// The SIMD widths (4 and 8) always start a block on a multiple of their width so it never straddles a byte
+			__forceinline void block(std::size_t first, int laneBits)
+			{
+				_mask.bits[first / 8] |= (std::uint8_t)(laneBits << (first % 8));
+			}
+
+			__forceinline void one(std::size_t index, bool hit)
+			{
+				if (hit)
+					_mask.bits[index / 8] |= (std::uint8_t)(1 << (index % 8));
+			}
+
+		private:
+			HitMask& _mask;
+		};
+
+		class IndexSink
+		{
+		public:
+			IndexSink(std::vector<std::uint32_t>& indices) : _indices(indices)
+			{
+				_indices.clear();
+			}
+
+			__forceinline void block(std::size_t first, int laneBits)
+			{
+				unsigned int remaining = (unsigned int)laneBits;
+				while (remaining)
+				{
+					_indices.push_back((std::uint32_t)(first + std::countr_zero(remaining)));
+					remaining &= remaining - 1;
+				}
+			}
+
+			__forceinline void one(std::size_t index, bool hit)
+			{
+				if (hit)
+					_indices.push_back((std::uint32_t)index);
+			}
+
+		private:
+			std::vector<std::uint32_t>& _indices;
+		};
+
+		template <typename instanceType>
+		__forceinline instanceType cross(instanceType ax, instanceType ay, instanceType bx, instanceType by)
+		{
+			return ax * by - ay * bx;
+		}
+
+		template <typename instanceType, typename Sink>
+		void pointsInAABB(const VecSoA2<instanceType>& points, const VecBase2<instanceType>& min, const VecBase2<instanceType>& max, Sink& sink)
+		{
+			std::size_t count = points.size();
+			std::size_t i = 0;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto minX = Lanes::set1(min.x), minY = Lanes::set1(min.y);
+				auto maxX = Lanes::set1(max.x), maxY = Lanes::set1(max.y);
+
+				for (; i + Lanes::width <= count; i += Lanes::width)
+				{
+					auto x = Lanes::loadu(points.x.data() + i);
+					auto y = Lanes::loadu(points.y.data() + i);
+					auto inX = Lanes::and_(Lanes::greaterEqual(x, minX), Lanes::lessEqual(x, maxX));
+					auto inY = Lanes::and_(Lanes::greaterEqual(y, minY), Lanes::lessEqual(y, maxY));
+					sink.block(i, Lanes::movemask(Lanes::and_(inX, inY)));
+				}
+			}
+
+			for (; i < count; i++)
+			{
+				instanceType x = points.x[i];
+				instanceType y = points.y[i];
+				sink.one(i, x >= min.x && x <= max.x && y >= min.y && y <= max.y);
+			}
+		}
+
+		// Crossing number test, each edge that crosses the horizontal line through the point to its right flips inside
+		template <typename instanceType, typename Sink>
+		void pointsInPolygon(const VecSoA2<instanceType>& points, std::span<const VecBase2<instanceType>> polygon, Sink& sink)
+		{
+			std::size_t count = points.size();
+			std::size_t edges = polygon.size();
+
+			// Work out each edges inverse slope once instead of once per point
+			struct Edge
+			{
+				instanceType ax, ay, by, slope;
+			};
+			std::vector<Edge> edgeList;
+			edgeList.reserve(edges);
+			for (std::size_t e = 0; e < edges; e++)
+			{
+				const VecBase2<instanceType>& a = polygon[e];
+				const VecBase2<instanceType>& b = polygon[(e + 1) % edges];
+				// Horizontal edges never cross the test line so their slope is never used
+				instanceType slope = (b.y != a.y) ? (b.x - a.x) / (b.y - a.y) : 0;
+				edgeList.push_back({ a.x, a.y, b.y, slope });
+			}
+
+			std::size_t i = 0;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+
+				for (; i + Lanes::width <= count; i += Lanes::width)
+				{
+					auto x = Lanes::loadu(points.x.data() + i);
+					auto y = Lanes::loadu(points.y.data() + i);
+					auto inside = Lanes::zero();
+
+					for (const Edge& edge : edgeList)
+					{
+						auto ay = Lanes::set1(edge.ay);
+						auto spans = Lanes::xor_(Lanes::greaterThan(ay, y), Lanes::greaterThan(Lanes::set1(edge.by), y));
+						auto crossX = Lanes::add(Lanes::set1(edge.ax), Lanes::mul(Lanes::sub(y, ay), Lanes::set1(edge.slope)));
+						inside = Lanes::xor_(inside, Lanes::and_(spans, Lanes::lessThan(x, crossX)));
+					}
+					sink.block(i, Lanes::movemask(inside));
+				}
+			}
+
+			for (; i < count; i++)
+			{
+				instanceType x = points.x[i];
+				instanceType y = points.y[i];
+				bool inside = false;
+
+				for (const Edge& edge : edgeList)
+				{
+					if ((edge.ay > y) != (edge.by > y) && x < edge.ax + (y - edge.ay) * edge.slope)
+						inside = !inside;
+				}
+				sink.one(i, inside);
+			}
+		}
+
+		// Touching and overlapping collinear segments count as intersecting
+		template <typename instanceType, typename Sink>
+		void segmentsIntersect(const VecSoA2<instanceType>& starts, const VecSoA2<instanceType>& ends, const VecBase2<instanceType>& queryStart, const VecBase2<instanceType>& queryEnd, Sink& sink)
+		{
+			std::size_t count = std::min(starts.size(), ends.size());
+
+			instanceType qdx = queryEnd.x - queryStart.x;
+			instanceType qdy = queryEnd.y - queryStart.y;
+			instanceType qMinX = std::min(queryStart.x, queryEnd.x), qMaxX = std::max(queryStart.x, queryEnd.x);
+			instanceType qMinY = std::min(queryStart.y, queryEnd.y), qMaxY = std::max(queryStart.y, queryEnd.y);
+
+			std::size_t i = 0;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto q0x = Lanes::set1(queryStart.x), q0y = Lanes::set1(queryStart.y);
+				auto q1x = Lanes::set1(queryEnd.x), q1y = Lanes::set1(queryEnd.y);
+				auto dx = Lanes::set1(qdx), dy = Lanes::set1(qdy);
+				auto minX = Lanes::set1(qMinX), maxX = Lanes::set1(qMaxX);
+				auto minY = Lanes::set1(qMinY), maxY = Lanes::set1(qMaxY);
+				auto zero = Lanes::zero();
+
+				auto Cross = [](auto ax, auto ay, auto bx, auto by) { return Lanes::sub(Lanes::mul(ax, by), Lanes::mul(ay, bx)); };
+
+				for (; i + Lanes::width <= count; i += Lanes::width)
+				{
+					auto c0x = Lanes::loadu(starts.x.data() + i), c0y = Lanes::loadu(starts.y.data() + i);
+					auto c1x = Lanes::loadu(ends.x.data() + i), c1y = Lanes::loadu(ends.y.data() + i);
+					auto cdx = Lanes::sub(c1x, c0x), cdy = Lanes::sub(c1y, c0y);
+
+					// Which side of each segment the others end points are on
+					auto d1 = Cross(dx, dy, Lanes::sub(c0x, q0x), Lanes::sub(c0y, q0y));
+					auto d2 = Cross(dx, dy, Lanes::sub(c1x, q0x), Lanes::sub(c1y, q0y));
+					auto d3 = Cross(cdx, cdy, Lanes::sub(q0x, c0x), Lanes::sub(q0y, c0y));
+					auto d4 = Cross(cdx, cdy, Lanes::sub(q1x, c0x), Lanes::sub(q1y, c0y));
+					auto straddles = Lanes::and_(Lanes::lessEqual(Lanes::mul(d1, d2), zero), Lanes::lessEqual(Lanes::mul(d3, d4), zero));
+
+					// Collinear segments pass the side test anywhere on the line so also need their boxes to overlap
+					auto collinear = Lanes::andNot(Lanes::or_(Lanes::notEqual(d1, zero), Lanes::notEqual(d2, zero)), straddles);
+					auto overlapX = Lanes::and_(Lanes::lessEqual(Lanes::min(c0x, c1x), maxX), Lanes::greaterEqual(Lanes::max(c0x, c1x), minX));
+					auto overlapY = Lanes::and_(Lanes::lessEqual(Lanes::min(c0y, c1y), maxY), Lanes::greaterEqual(Lanes::max(c0y, c1y), minY));
+					auto rejected = Lanes::andNot(Lanes::and_(overlapX, overlapY), collinear);
+
+					sink.block(i, Lanes::movemask(Lanes::andNot(rejected, straddles)));
+				}
+			}
+
+			for (; i < count; i++)
+			{
+				instanceType c0x = starts.x[i], c0y = starts.y[i];
+				instanceType c1x = ends.x[i], c1y = ends.y[i];
+				instanceType cdx = c1x - c0x, cdy = c1y - c0y;
+
+				instanceType d1 = cross(qdx, qdy, c0x - queryStart.x, c0y - queryStart.y);
+				instanceType d2 = cross(qdx, qdy, c1x - queryStart.x, c1y - queryStart.y);
+				instanceType d3 = cross(cdx, cdy, queryStart.x - c0x, queryStart.y - c0y);
+				instanceType d4 = cross(cdx, cdy, queryEnd.x - c0x, queryEnd.y - c0y);
+				bool straddles = d1 * d2 <= 0 && d3 * d4 <= 0;
+
+				if (straddles && d1 == 0 && d2 == 0)
+				{
+					straddles = std::min(c0x, c1x) <= qMaxX && std::max(c0x, c1x) >= qMinX
+						&& std::min(c0y, c1y) <= qMaxY && std::max(c0y, c1y) >= qMinY;
+				}
+				sink.one(i, straddles);
+			}
+		}
+
+		// Ray is origin + t * direction for t >= 0, direction does not need to be normalized
+		template <typename instanceType, typename Sink>
+		void rayVsCircles(const VecSoA2<instanceType>& centers, std::span<const instanceType> radii, const VecBase2<instanceType>& origin, const VecBase2<instanceType>& direction, Sink& sink)
+		{
+			std::size_t count = std::min(centers.size(), radii.size());
+			instanceType dirDot = direction.x * direction.x + direction.y * direction.y;
+
+			std::size_t i = 0;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto ox = Lanes::set1(origin.x), oy = Lanes::set1(origin.y);
+				auto dx = Lanes::set1(direction.x), dy = Lanes::set1(direction.y);
+				auto a = Lanes::set1(dirDot);
+				auto zero = Lanes::zero();
+
+				for (; i + Lanes::width <= count; i += Lanes::width)
+				{
+					auto mx = Lanes::sub(Lanes::loadu(centers.x.data() + i), ox);
+					auto my = Lanes::sub(Lanes::loadu(centers.y.data() + i), oy);
+					auto r = Lanes::loadu(radii.data() + i);
+
+					auto b = Lanes::add(Lanes::mul(mx, dx), Lanes::mul(my, dy));
+					auto c = Lanes::sub(Lanes::add(Lanes::mul(mx, mx), Lanes::mul(my, my)), Lanes::mul(r, r));
+
+					// Starting inside always hits, otherwise the circle has to be ahead and the line has to reach it
+					auto inside = Lanes::lessEqual(c, zero);
+					auto ahead = Lanes::greaterThan(b, zero);
+					auto reaches = Lanes::greaterEqual(Lanes::sub(Lanes::mul(b, b), Lanes::mul(a, c)), zero);
+					sink.block(i, Lanes::movemask(Lanes::or_(inside, Lanes::and_(ahead, reaches))));
+				}
+			}
+
+			for (; i < count; i++)
+			{
+				instanceType mx = centers.x[i] - origin.x;
+				instanceType my = centers.y[i] - origin.y;
+				instanceType b = mx * direction.x + my * direction.y;
+				instanceType c = mx * mx + my * my - radii[i] * radii[i];
+				sink.one(i, c <= 0 || (b > 0 && b * b - dirDot * c >= 0));
+			}
+		}
+
+		// Writes the closest point on segments [first, first + count) and the squared distance to it
+		// Outputs are indexed from 0 and any of them can be null
+		template <typename instanceType>
+		void closestPointOnSegments(const VecSoA2<instanceType>& starts, const VecSoA2<instanceType>& ends, const VecBase2<instanceType>& point, instanceType* outX, instanceType* outY, instanceType* outDistSq, std::size_t first, std::size_t count)
+		{
+			const instanceType* startX = starts.x.data() + first;
+			const instanceType* startY = starts.y.data() + first;
+			const instanceType* endX = ends.x.data() + first;
+			const instanceType* endY = ends.y.data() + first;
+			std::size_t i = 0;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto px = Lanes::set1(point.x), py = Lanes::set1(point.y);
+				auto zero = Lanes::zero();
+				auto one = Lanes::set1(1);
+
+				for (; i + Lanes::width <= count; i += Lanes::width)
+				{
+					auto ax = Lanes::loadu(startX + i), ay = Lanes::loadu(startY + i);
+					auto abx = Lanes::sub(Lanes::loadu(endX + i), ax);
+					auto aby = Lanes::sub(Lanes::loadu(endY + i), ay);
+
+					auto along = Lanes::add(Lanes::mul(Lanes::sub(px, ax), abx), Lanes::mul(Lanes::sub(py, ay), aby));
+					auto lengthSq = Lanes::add(Lanes::mul(abx, abx), Lanes::mul(aby, aby));
+					// Zero length segments divide by zero here and get snapped to their start below
+					auto t = Lanes::min(Lanes::max(Lanes::div(along, lengthSq), zero), one);
+					t = Lanes::select(Lanes::greaterThan(lengthSq, zero), zero, t);
+
+					auto cx = Lanes::add(ax, Lanes::mul(abx, t));
+					auto cy = Lanes::add(ay, Lanes::mul(aby, t));
+					if (outX)
+						Lanes::storeu(outX + i, cx);
+					if (outY)
+						Lanes::storeu(outY + i, cy);
+					if (outDistSq)
+					{
+						auto ex = Lanes::sub(px, cx), ey = Lanes::sub(py, cy);
+						Lanes::storeu(outDistSq + i, Lanes::add(Lanes::mul(ex, ex), Lanes::mul(ey, ey)));
+					}
+				}
+			}
+
+			for (; i < count; i++)
+			{
+				instanceType ax = startX[i], ay = startY[i];
+				instanceType abx = endX[i] - ax, aby = endY[i] - ay;
+				instanceType lengthSq = abx * abx + aby * aby;
+
+				instanceType t = 0;
+				if (lengthSq > 0)
+					t = math::clamp<instanceType>(((point.x - ax) * abx + (point.y - ay) * aby) / lengthSq, 0, 1);
+
+				instanceType cx = ax + abx * t;
+				instanceType cy = ay + aby * t;
+				if (outX)
+					outX[i] = cx;
+				if (outY)
+					outY[i] = cy;
+				if (outDistSq)
+					outDistSq[i] = (point.x - cx) * (point.x - cx) + (point.y - cy) * (point.y - cy);
+			}
+		}
+
+		template <typename instanceType, typename Sink>
+		void segmentsNearPoint(const VecSoA2<instanceType>& starts, const VecSoA2<instanceType>& ends, const VecBase2<instanceType>& point, instanceType radius, Sink& sink)
+		{
+			std::size_t count = std::min(starts.size(), ends.size());
+			instanceType radiusSq = radius * radius;
+
+			// Work through a fixed size block on the stack so this stays allocation free
+			constexpr std::size_t blockSize = 256;
+			instanceType distSq[blockSize];
+
+			for (std::size_t first = 0; first < count; first += blockSize)
+			{
+				std::size_t blockCount = std::min(blockSize, count - first);
+				closestPointOnSegments(starts, ends, point, (instanceType*)nullptr, (instanceType*)nullptr, distSq, first, blockCount);
+
+				std::size_t i = 0;
+				if constexpr (SimdLanes<instanceType>::enabled)
+				{
+					using Lanes = SimdLanes<instanceType>;
+					auto limit = Lanes::set1(radiusSq);
+					for (; i + Lanes::width <= blockCount; i += Lanes::width)
+						sink.block(first + i, Lanes::movemask(Lanes::lessEqual(Lanes::loadu(distSq + i), limit)));
+				}
+
+				for (; i < blockCount; i++)
+					sink.one(first + i, distSq[i] <= radiusSq);
+			}
+		}
+	}
+
+	// Points inside (or on the edge of) the box [min, max]
+	template <typename instanceType>
+	void PointsInAABB(const VecSoA2<instanceType>& points, const VecBase2<instanceType>& min, const VecBase2<instanceType>& max, HitMask& mask)
+	{
+		detail::MaskSink sink(mask, points.size());
+		detail::pointsInAABB(points, min, max, sink);
+	}
+
+	template <typename instanceType>
+	void PointsInAABB(const VecSoA2<instanceType>& points, const VecBase2<instanceType>& min, const VecBase2<instanceType>& max, std::vector<std::uint32_t>& indices)
+	{
+		detail::IndexSink sink(indices);
+		detail::pointsInAABB(points, min, max, sink);
+	}
+
+	// Points inside a simple polygon given as its corners in order, the last corner joins back to the first
+	// Points exactly on an edge can land either way
+	template <typename instanceType>
+	void PointsInPolygon(const VecSoA2<instanceType>& points, std::span<const VecBase2<instanceType>> polygon, HitMask& mask)
+	{
+		detail::MaskSink sink(mask, points.size());
+		detail::pointsInPolygon(points, polygon, sink);
+	}
+
+	template <typename instanceType>
+	void PointsInPolygon(const VecSoA2<instanceType>& points, std::span<const VecBase2<instanceType>> polygon, std::vector<std::uint32_t>& indices)
+	{
+		detail::IndexSink sink(indices);
+		detail::pointsInPolygon(points, polygon, sink);
+	}
+
+	// Candidate segments are starts[i] -> ends[i], touching counts as a hit
+	template <typename instanceType>
+	void SegmentsIntersect(const VecSoA2<instanceType>& starts, const VecSoA2<instanceType>& ends, const VecBase2<instanceType>& queryStart, const VecBase2<instanceType>& queryEnd, HitMask& mask)
+	{
+		detail::MaskSink sink(mask, std::min(starts.size(), ends.size()));
+		detail::segmentsIntersect(starts, ends, queryStart, queryEnd, sink);
+	}
+
+	template <typename instanceType>
+	void SegmentsIntersect(const VecSoA2<instanceType>& starts, const VecSoA2<instanceType>& ends, const VecBase2<instanceType>& queryStart, const VecBase2<instanceType>& queryEnd, std::vector<std::uint32_t>& indices)
+	{
+		detail::IndexSink sink(indices);
+		detail::segmentsIntersect(starts, ends, queryStart, queryEnd, sink);
+	}
+
+	// Circles centers[i] with radii[i] hit by the ray origin + t * direction, t >= 0
+	template <typename instanceType>
+	void RayVsCircles(const VecSoA2<instanceType>& centers, std::span<const instanceType> radii, const VecBase2<instanceType>& origin, const VecBase2<instanceType>& direction, HitMask& mask)
+	{
+		detail::MaskSink sink(mask, std::min(centers.size(), radii.size()));
+		detail::rayVsCircles(centers, radii, origin, direction, sink);
+	}
+
+	template <typename instanceType>
+	void RayVsCircles(const VecSoA2<instanceType>& centers, std::span<const instanceType> radii, const VecBase2<instanceType>& origin, const VecBase2<instanceType>& direction, std::vector<std::uint32_t>& indices)
+	{
+		detail::IndexSink sink(indices);
+		detail::rayVsCircles(centers, radii, origin, direction, sink);
+	}
+
+	// closest gets the point on each segment nearest to point, distancesSquared (if given) the squared distance to it
+	template <typename instanceType>
+	void ClosestPointOnSegments(const VecSoA2<instanceType>& starts, const VecSoA2<instanceType>& ends, const VecBase2<instanceType>& point, VecSoA2<instanceType>& closest, std::vector<instanceType>* distancesSquared = nullptr)
+	{
+		std::size_t count = std::min(starts.size(), ends.size());
+		closest.resize(count);
+		if (distancesSquared)
+			distancesSquared->resize(count);
+
+		detail::closestPointOnSegments(starts, ends, point, closest.x.data(), closest.y.data(), distancesSquared ? distancesSquared->data() : nullptr, 0, count);
+	}
+
+	// Segments that come within radius of point
+	template <typename instanceType>
+	void SegmentsNearPoint(const VecSoA2<instanceType>& starts, const VecSoA2<instanceType>& ends, const VecBase2<instanceType>& point, instanceType radius, HitMask& mask)
+	{
+		detail::MaskSink sink(mask, std::min(starts.size(), ends.size()));
+		detail::segmentsNearPoint(starts, ends, point, radius, sink);
+	}
+
+	template <typename instanceType>
+	void SegmentsNearPoint(const VecSoA2<instanceType>& starts, const VecSoA2<instanceType>& ends, const VecBase2<instanceType>& point, instanceType radius, std::vector<std::uint32_t>& indices)
+	{
+		detail::IndexSink sink(indices);
+		detail::segmentsNearPoint(starts, ends, point, radius, sink);
+	}
+}
@@ -0,0 +1,663 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include "VecBase.h"
+#include "VecSoA.h"
+#include "VecSimd.h"
+#include "../ThreadPool/ThreadPool.h"
+
+// Bulk reductions and transforms over big collections of VecBase2
+// Every function has an overload for std::span<const VecBase2<T>> and one for VecSoA2<T>
+// The inner loops use SimdLanes when the type has a wide path and the outer loop is split into
+// chunks that are ran on a ThreadPool
+// The span overloads cant deduce the type from a std::vector so name it, VecReduce::Sum<float>(positions)
+namespace VecReduce
+{
+	static constexpr std::size_t npos = SIZE_MAX;
+
+	struct ReduceOptions
+	{
+		// When true the input is cut into grainSize chunks and the partial results are combined with a
+		// fixed pairwise tree, so the result only depends on the input and grainSize and never on the
+		// number of threads. When false the chunk count follows the pool size instead
+		bool deterministic = false;
+
+		// Number of vectors a single task works on, anything smaller than this stays on the calling thread
+		std::size_t grainSize = 1 << 16;
+
+		// Pool to run on, nullptr means ThreadPool::shared()
+		ThreadPool* pool = nullptr;
+	};
+
+	template <typename instanceType>
+	struct Bounds2
+	{
+		VecBase2<instanceType> min;
+		VecBase2<instanceType> max;
+	};
+
+	template <typename instanceType>
+	struct MagnitudeRange
+	{
+		instanceType min;
+		instanceType max;
+	};
+
+	template <typename instanceType>
+	struct ClosestResult
+	{
+		// npos when the input was empty
+		std::size_t index;
+		instanceType distanceSquared;
+	};
+
+	namespace detail
+	{
+		static_assert(sizeof(VecBase2<float>) == sizeof(float) * 2, "VecBase2 must be two tightly packed components");
+		static_assert(sizeof(VecBase2<double>) == sizeof(double) * 2, "VecBase2 must be two tightly packed components");
+
+		// Either an interleaved x,y,x,y array or a pair of separate x and y arrays
+		template <typename instanceType>
+		struct VecSource
+		{
+			const instanceType* interleaved = nullptr;
+			const instanceType* xs = nullptr;
+			const instanceType* ys = nullptr;
+			std::size_t count = 0;
+
+			static VecSource fromSpan(std::span<const VecBase2<instanceType>> vecs)
+			{
+				VecSource source;
+				source.interleaved = reinterpret_cast<const instanceType*>(vecs.data());
+				source.count = vecs.size();
+				return source;
+			}
+
+			static VecSource fromSoA(const VecSoA2<instanceType>& vecs)
+			{
+				VecSource source;
+				source.xs = vecs.x.data();
+				source.ys = vecs.y.data();
+				source.count = vecs.size();
+				return source;
+			}
+
+			__forceinline instanceType xAt(std::size_t index) const
+			{
+				return interleaved ? interleaved[index * 2] : xs[index];
+			}
+
+			__forceinline instanceType yAt(std::size_t index) const
+			{
+				return interleaved ? interleaved[index * 2 + 1] : ys[index];
+			}
+		};
+
+		// Largest value a running minimum can start from
+		template <typename instanceType>
+		constexpr instanceType highest()
+		{
+			if constexpr (std::numeric_limits<instanceType>::has_infinity)
+				return std::numeric_limits<instanceType>::infinity();
+			else
+				return std::numeric_limits<instanceType>::max();
+		}
+
+		template <typename instanceType>
+		constexpr instanceType lowest()
+		{
+			if constexpr (std::numeric_limits<instanceType>::has_infinity)
+				return -std::numeric_limits<instanceType>::infinity();
+			else
+				return std::numeric_limits<instanceType>::lowest();
+		}
+
+		// Calls block(x, y, laneIndex) on every full SIMD block in [begin, end), laneIndex holds each lanes
+		// offset from begin. Returns the first index that did not fit in a full block
+		// Only valid for types where SimdLanes is enabled
+		template <typename instanceType, typename BlockFn>
+		__forceinline std::size_t forEachBlock(const VecSource<instanceType>& source, std::size_t begin, std::size_t end, BlockFn&& block)
+		{
+			using Lanes = SimdLanes<instanceType>;
+			constexpr std::size_t width = Lanes::width;
+
+			std::size_t i = begin;
+			if (source.interleaved)
+			{
+				auto laneIndex = Lanes::aosOrder();
+				for (; i + width <= end; i += width)
+				{
+					typename Lanes::Reg x, y;
+					Lanes::loadAoS(source.interleaved + i * 2, x, y);
+					block(x, y, laneIndex);
+					laneIndex = Lanes::addIndex(laneIndex, width);
+				}
+			}
+			else
+			{
+				auto laneIndex = Lanes::soaOrder();
+				for (; i + width <= end; i += width)
+				{
+					block(Lanes::loadu(source.xs + i), Lanes::loadu(source.ys + i), laneIndex);
+					laneIndex = Lanes::addIndex(laneIndex, width);
+				}
+			}
+			return i;
+		}
+
+		// Folds the lanes of a register in a fixed order so results dont depend on the compiler
+		template <typename instanceType, typename Reg, typename CombineFn>
+		__forceinline instanceType foldLanes(Reg value, CombineFn&& combine)
+		{
+			using Lanes = SimdLanes<instanceType>;
+			alignas(32) instanceType lanes[Lanes::width];
+			Lanes::storeu(lanes, value);
+
+			instanceType result = lanes[0];
+			for (std::size_t i = 1; i < Lanes::width; i++)
+				result = combine(result, lanes[i]);
+			return result;
+		}
+
+		__forceinline ThreadPool& poolFor(const ReduceOptions& options)
+		{
+			return options.pool ? *options.pool : ThreadPool::shared();
+		}
+
+		// Works out how [0, count) gets split, see ReduceOptions::deterministic
+		__forceinline std::size_t chunkCountFor(std::size_t count, const ReduceOptions& options)
+		{
+			std::size_t grain = std::max<std::size_t>(options.grainSize, 1);
+			std::size_t chunkCount = (count + grain - 1) / grain;
+
+			if (!options.deterministic)
+			{
+				// A few chunks per thread is enough to balance and keeps the combine step tiny
+				chunkCount = std::min(chunkCount, poolFor(options).concurrency() * 4);
+			}
+			return std::max<std::size_t>(chunkCount, 1);
+		}
+
+		// Runs chunk(begin, end) over [0, count) and combines the partials with a fixed pairwise tree
+		template <typename Partial, typename ChunkFn, typename CombineFn>
+		Partial parallelReduce(std::size_t count, const ReduceOptions& options, const Partial& identity, ChunkFn&& chunk, CombineFn&& combine)
+		{
+			if (count == 0)
+				return identity;
+
+			std::size_t chunkCount = chunkCountFor(count, options);
+			std::size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+			if (chunkCount == 1)
+				return chunk(std::size_t(0), count);
+
+			std::vector<Partial> partials(chunkCount, identity);
+			poolFor(options).parallelFor(chunkCount, [&](std::size_t chunkIndex)
+			{
+				std::size_t begin = std::min(count, chunkIndex * chunkSize);
+				std::size_t end = std::min(count, begin + chunkSize);
+				partials[chunkIndex] = chunk(begin, end);
+			});
+
+			// The shape of this tree only depends on chunkCount
+			for (std::size_t stride = 1; stride < chunkCount; stride *= 2)
+			{
+				for (std::size_t i = 0; i + stride < chunkCount; i += stride * 2)
+				{
+					partials[i] = combine(partials[i], partials[i + stride]);
+				}
+			}
+			return partials[0];
+		}
+
+		// Runs chunk(begin, end) over [0, count) with the same chunking as parallelReduce
+		template <typename ChunkFn>
+		void parallelChunks(std::size_t count, const ReduceOptions& options, ChunkFn&& chunk)
+		{
+			if (count == 0)
+				return;
+
+			std::size_t chunkCount = chunkCountFor(count, options);
+			std::size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+			if (chunkCount == 1)
+			{
+				chunk(std::size_t(0), count);
+				return;
+			}
+
+			poolFor(options).parallelFor(chunkCount, [&](std::size_t chunkIndex)
+			{
+				std::size_t begin = std::min(count, chunkIndex * chunkSize);
+				std::size_t end = std::min(count, begin + chunkSize);
+				chunk(begin, end);
+			});
+		}
+
+		template <typename instanceType>
+		VecBase2<instanceType> sumChunk(const VecSource<instanceType>& source, std::size_t begin, std::size_t end)
+		{
+			instanceType sumX = 0;
+			instanceType sumY = 0;
+			std::size_t i = begin;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto accX = Lanes::zero();
+				auto accY = Lanes::zero();
+
+				i = forEachBlock(source, begin, end, [&](auto x, auto y, auto)
+				{
+					accX = Lanes::add(accX, x);
+					accY = Lanes::add(accY, y);
+				});
+
+				auto Add = [](instanceType a, instanceType b) { return a + b; };
+				sumX = foldLanes<instanceType>(accX, Add);
+				sumY = foldLanes<instanceType>(accY, Add);
+			}
+
+			for (; i < end; i++)
+			{
+				sumX += source.xAt(i);
+				sumY += source.yAt(i);
+			}
+			return VecBase2<instanceType>(sumX, sumY);
+		}
+
+		template <typename instanceType>
+		Bounds2<instanceType> boundsChunk(const VecSource<instanceType>& source, std::size_t begin, std::size_t end)
+		{
+			instanceType minX = highest<instanceType>(), minY = highest<instanceType>();
+			instanceType maxX = lowest<instanceType>(), maxY = lowest<instanceType>();
+			std::size_t i = begin;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto lowX = Lanes::set1(minX), lowY = Lanes::set1(minY);
+				auto highX = Lanes::set1(maxX), highY = Lanes::set1(maxY);
+
+				i = forEachBlock(source, begin, end, [&](auto x, auto y, auto)
+				{
+					lowX = Lanes::min(lowX, x);
+					lowY = Lanes::min(lowY, y);
+					highX = Lanes::max(highX, x);
+					highY = Lanes::max(highY, y);
+				});
+
+				auto Min = [](instanceType a, instanceType b) { return std::min(a, b); };
+				auto Max = [](instanceType a, instanceType b) { return std::max(a, b); };
+				minX = foldLanes<instanceType>(lowX, Min);
+				minY = foldLanes<instanceType>(lowY, Min);
+				maxX = foldLanes<instanceType>(highX, Max);
+				maxY = foldLanes<instanceType>(highY, Max);
+			}
+
+			for (; i < end; i++)
+			{
+				minX = std::min(minX, source.xAt(i));
+				minY = std::min(minY, source.yAt(i));
+				maxX = std::max(maxX, source.xAt(i));
+				maxY = std::max(maxY, source.yAt(i));
+			}
+			return { VecBase2<instanceType>(minX, minY), VecBase2<instanceType>(maxX, maxY) };
+		}
+
+		// Works on squared magnitudes, the callers take the root once at the end
+		template <typename instanceType>
+		MagnitudeRange<instanceType> magnitudeChunk(const VecSource<instanceType>& source, std::size_t begin, std::size_t end)
+		{
+			instanceType minSq = highest<instanceType>();
+			instanceType maxSq = 0;
+			std::size_t i = begin;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto low = Lanes::set1(minSq);
+				auto high = Lanes::zero();
+
+				i = forEachBlock(source, begin, end, [&](auto x, auto y, auto)
+				{
+					auto magSq = Lanes::add(Lanes::mul(x, x), Lanes::mul(y, y));
+					low = Lanes::min(low, magSq);
+					high = Lanes::max(high, magSq);
+				});
+
+				minSq = foldLanes<instanceType>(low, [](instanceType a, instanceType b) { return std::min(a, b); });
+				maxSq = foldLanes<instanceType>(high, [](instanceType a, instanceType b) { return std::max(a, b); });
+			}
+
+			for (; i < end; i++)
+			{
+				instanceType x = source.xAt(i);
+				instanceType y = source.yAt(i);
+				instanceType magSq = x * x + y * y;
+				minSq = std::min(minSq, magSq);
+				maxSq = std::max(maxSq, magSq);
+			}
+			return { minSq, maxSq };
+		}
+
+		// Ties go to the lower index so the answer never depends on the lane or chunk layout
+		template <typename instanceType>
+		__forceinline ClosestResult<instanceType> closerOf(const ClosestResult<instanceType>& a, const ClosestResult<instanceType>& b)
+		{
+			if (b.distanceSquared < a.distanceSquared || (b.distanceSquared == a.distanceSquared && b.index < a.index))
+				return b;
+			return a;
+		}
+
+		template <typename instanceType>
+		ClosestResult<instanceType> closestChunk(const VecSource<instanceType>& source, std::size_t begin, std::size_t end, const VecBase2<instanceType>& query)
+		{
+			ClosestResult<instanceType> best = { npos, highest<instanceType>() };
+			std::size_t i = begin;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto queryX = Lanes::set1(query.x);
+				auto queryY = Lanes::set1(query.y);
+				auto bestDist = Lanes::set1(best.distanceSquared);
+				// Any lane that never picks anything (only NaN distances) keeps -1 and gets skipped below
+				auto bestIndex = Lanes::setIndex(-1);
+				// Every lane starts out empty, comparing the starting distance with itself gives all ones
+				auto empty = Lanes::lessEqual(bestDist, bestDist);
+				bool anyBlock = false;
+
+				i = forEachBlock(source, begin, end, [&](auto x, auto y, auto laneIndex)
+				{
+					auto dx = Lanes::sub(x, queryX);
+					auto dy = Lanes::sub(y, queryY);
+					auto dist = Lanes::add(Lanes::mul(dx, dx), Lanes::mul(dy, dy));
+					// Same rule as closerOf, an empty lane takes anything up to and including the starting distance
+					// so a chunk where every distance is infinite still gives its first index like the scalar path
+					auto closer = Lanes::or_(Lanes::lessThan(dist, bestDist), Lanes::and_(empty, Lanes::lessEqual(dist, bestDist)));
+					bestDist = Lanes::select(closer, bestDist, dist);
+					bestIndex = Lanes::selectIndex(closer, bestIndex, laneIndex);
+					empty = Lanes::andNot(closer, empty);
+					anyBlock = true;
+				});
+
+				if (anyBlock)
+				{
+					alignas(32) instanceType dists[Lanes::width];
+					alignas(32) typename Lanes::IndexType indices[Lanes::width];
+					Lanes::storeu(dists, bestDist);
+					Lanes::storeIndex(indices, bestIndex);
+
+					for (std::size_t lane = 0; lane < Lanes::width; lane++)
+					{
+						if (indices[lane] < 0)
+							continue;
+						best = closerOf(best, { begin + (std::size_t)indices[lane], dists[lane] });
+					}
+				}
+			}
+
+			for (; i < end; i++)
+			{
+				instanceType dx = source.xAt(i) - query.x;
+				instanceType dy = source.yAt(i) - query.y;
+				best = closerOf(best, { i, dx * dx + dy * dy });
+			}
+			return best;
+		}
+
+		template <typename instanceType>
+		Bounds2<instanceType> boundingBox(const VecSource<instanceType>& source, const ReduceOptions& options)
+		{
+			Bounds2<instanceType> identity = {
+				VecBase2<instanceType>(highest<instanceType>(), highest<instanceType>()),
+				VecBase2<instanceType>(lowest<instanceType>(), lowest<instanceType>())
+			};
+
+			return parallelReduce(source.count, options, identity,
+				[&](std::size_t begin, std::size_t end) { return boundsChunk(source, begin, end); },
+				[](const Bounds2<instanceType>& a, const Bounds2<instanceType>& b) -> Bounds2<instanceType>
+				{
+					return {
+						VecBase2<instanceType>(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)),
+						VecBase2<instanceType>(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y))
+					};
+				});
+		}
+
+		template <typename instanceType>
+		VecBase2<instanceType> sum(const VecSource<instanceType>& source, const ReduceOptions& options)
+		{
+			return parallelReduce(source.count, options, VecBase2<instanceType>(0, 0),
+				[&](std::size_t begin, std::size_t end) { return sumChunk(source, begin, end); },
+				[](const VecBase2<instanceType>& a, const VecBase2<instanceType>& b) { return VecBase2<instanceType>(a.x + b.x, a.y + b.y); });
+		}
+
+		template <typename instanceType>
+		VecBase2<instanceType> centroid(const VecSource<instanceType>& source, const ReduceOptions& options)
+		{
+			if (source.count == 0)
+				return VecBase2<instanceType>(0, 0);
+
+			VecBase2<instanceType> total = sum(source, options);
+			return VecBase2<instanceType>(total.x / (instanceType)source.count, total.y / (instanceType)source.count);
+		}
+
+		template <typename instanceType>
+		MagnitudeRange<instanceType> magnitudeRange(const VecSource<instanceType>& source, const ReduceOptions& options)
+		{
+			if (source.count == 0)
+				return { 0, 0 };
+
+			MagnitudeRange<instanceType> squared = parallelReduce(source.count, options, MagnitudeRange<instanceType>{ highest<instanceType>(), 0 },
+				[&](std::size_t begin, std::size_t end) { return magnitudeChunk(source, begin, end); },
+				[](const MagnitudeRange<instanceType>& a, const MagnitudeRange<instanceType>& b) -> MagnitudeRange<instanceType>
+				{
+					return { std::min(a.min, b.min), std::max(a.max, b.max) };
+				});
+
+			return { (instanceType)std::sqrt(squared.min), (instanceType)std::sqrt(squared.max) };
+		}
+
+		template <typename instanceType>
+		ClosestResult<instanceType> closestPoint(const VecSource<instanceType>& source, const VecBase2<instanceType>& query, const ReduceOptions& options)
+		{
+			return parallelReduce(source.count, options, ClosestResult<instanceType>{ npos, highest<instanceType>() },
+				[&](std::size_t begin, std::size_t end) { return closestChunk(source, begin, end, query); },
+				[](const ClosestResult<instanceType>& a, const ClosestResult<instanceType>& b) { return closerOf(a, b); });
+		}
+
+		// out[i] = in[i] * scale + offset on a flat array of count x,y pairs
+		template <typename instanceType>
+		void scaleOffsetInterleaved(const instanceType* in, instanceType* out, std::size_t begin, std::size_t end, const VecBase2<instanceType>& scale, const VecBase2<instanceType>& offset)
+		{
+			std::size_t i = begin * 2;
+			std::size_t last = end * 2;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto scaleReg = Lanes::setPair(scale.x, scale.y);
+				auto offsetReg = Lanes::setPair(offset.x, offset.y);
+				for (; i + Lanes::width <= last; i += Lanes::width)
+				{
+					Lanes::storeu(out + i, Lanes::add(Lanes::mul(Lanes::loadu(in + i), scaleReg), offsetReg));
+				}
+			}
+
+			for (; i < last; i += 2)
+			{
+				out[i] = in[i] * scale.x + offset.x;
+				out[i + 1] = in[i + 1] * scale.y + offset.y;
+			}
+		}
+
+		// out[i] = in[i] * scale + offset on a single component array
+		template <typename instanceType>
+		void scaleOffsetPlanar(const instanceType* in, instanceType* out, std::size_t begin, std::size_t end, instanceType scale, instanceType offset)
+		{
+			std::size_t i = begin;
+
+			if constexpr (SimdLanes<instanceType>::enabled)
+			{
+				using Lanes = SimdLanes<instanceType>;
+				auto scaleReg = Lanes::set1(scale);
+				auto offsetReg = Lanes::set1(offset);
+				for (; i + Lanes::width <= end; i += Lanes::width)
+				{
+					Lanes::storeu(out + i, Lanes::add(Lanes::mul(Lanes::loadu(in + i), scaleReg), offsetReg));
+				}
+			}
+
+			for (; i < end; i++)
+			{
+				out[i] = in[i] * scale + offset;
+			}
+		}
+	}
+
+	// Smallest box holding every vector, an empty input gives min = +max and max = lowest
+	template <typename instanceType>
+	Bounds2<instanceType> BoundingBox(std::span<const VecBase2<instanceType>> vecs, const ReduceOptions& options = {})
+	{
+		return detail::boundingBox(detail::VecSource<instanceType>::fromSpan(vecs), options);
+	}
+
+	template <typename instanceType>
+	Bounds2<instanceType> BoundingBox(const VecSoA2<instanceType>& vecs, const ReduceOptions& options = {})
+	{
+		return detail::boundingBox(detail::VecSource<instanceType>::fromSoA(vecs), options);
+	}
+
+	template <typename instanceType>
+	VecBase2<instanceType> Sum(std::span<const VecBase2<instanceType>> vecs, const ReduceOptions& options = {})
+	{
+		return detail::sum(detail::VecSource<instanceType>::fromSpan(vecs), options);
+	}
+
+	template <typename instanceType>
+	VecBase2<instanceType> Sum(const VecSoA2<instanceType>& vecs, const ReduceOptions& options = {})
+	{
+		return detail::sum(detail::VecSource<instanceType>::fromSoA(vecs), options);
+	}
+
+	// Average of all the vectors, (0, 0) for an empty input
+	template <typename instanceType>
+	VecBase2<instanceType> Centroid(std::span<const VecBase2<instanceType>> vecs, const ReduceOptions& options = {})
+	{
+		return detail::centroid(detail::VecSource<instanceType>::fromSpan(vecs), options);
+	}
+
+	template <typename instanceType>
+	VecBase2<instanceType> Centroid(const VecSoA2<instanceType>& vecs, const ReduceOptions& options = {})
+	{
+		return detail::centroid(detail::VecSource<instanceType>::fromSoA(vecs), options);
+	}
+
+	// Smallest and largest Magnitude() in one pass
+	template <typename instanceType>
+	MagnitudeRange<instanceType> MinMaxMagnitude(std::span<const VecBase2<instanceType>> vecs, const ReduceOptions& options = {})
+	{
+		return detail::magnitudeRange(detail::VecSource<instanceType>::fromSpan(vecs), options);
+	}
+
+	template <typename instanceType>
+	MagnitudeRange<instanceType> MinMaxMagnitude(const VecSoA2<instanceType>& vecs, const ReduceOptions& options = {})
+	{
+		return detail::magnitudeRange(detail::VecSource<instanceType>::fromSoA(vecs), options);
+	}
+
+	// Index of the vector closest to query, ties go to the lowest index
+	template <typename instanceType>
+	ClosestResult<instanceType> ClosestPoint(std::span<const VecBase2<instanceType>> vecs, const VecBase2<instanceType>& query, const ReduceOptions& options = {})
+	{
+		return detail::closestPoint(detail::VecSource<instanceType>::fromSpan(vecs), query, options);
+	}
+
+	template <typename instanceType>
+	ClosestResult<instanceType> ClosestPoint(const VecSoA2<instanceType>& vecs, const VecBase2<instanceType>& query, const ReduceOptions& options = {})
+	{
+		return detail::closestPoint(detail::VecSource<instanceType>::fromSoA(vecs), query, options);
+	}
+
+	// out[i] = in[i] * scale + offset, in and out can be the same span
+	template <typename instanceType>
+	void ScaleOffset(std::span<const VecBase2<instanceType>> in, std::span<VecBase2<instanceType>> out, const VecBase2<instanceType>& scale, const VecBase2<instanceType>& offset, const ReduceOptions& options = {})
+	{
+		const instanceType* from = reinterpret_cast<const instanceType*>(in.data());
+		instanceType* to = reinterpret_cast<instanceType*>(out.data());
+
+		detail::parallelChunks(std::min(in.size(), out.size()), options, [&](std::size_t begin, std::size_t end)
+		{
+			detail::scaleOffsetInterleaved(from, to, begin, end, scale, offset);
+		});
+	}
+
+	// out is resized to match in, in and out can be the same object
+	template <typename instanceType>
+	void ScaleOffset(const VecSoA2<instanceType>& in, VecSoA2<instanceType>& out, const VecBase2<instanceType>& scale, const VecBase2<instanceType>& offset, const ReduceOptions& options = {})
+	{
+		out.resize(in.size());
+
+		detail::parallelChunks(in.size(), options, [&](std::size_t begin, std::size_t end)
+		{
+			detail::scaleOffsetPlanar(in.x.data(), out.x.data(), begin, end, scale.x, offset.x);
+			detail::scaleOffsetPlanar(in.y.data(), out.y.data(), begin, end, scale.y, offset.y);
+		});
+	}
+
+	template <typename instanceType>
+	void Translate(std::span<const VecBase2<instanceType>> in, std::span<VecBase2<instanceType>> out, const VecBase2<instanceType>& offset, const ReduceOptions& options = {})
+	{
+		ScaleOffset(in, out, VecBase2<instanceType>(1, 1), offset, options);
+	}
+
+	template <typename instanceType>
+	void Translate(const VecSoA2<instanceType>& in, VecSoA2<instanceType>& out, const VecBase2<instanceType>& offset, const ReduceOptions& options = {})
+	{
+		ScaleOffset(in, out, VecBase2<instanceType>(1, 1), offset, options);
+	}
+
+	template <typename instanceType>
+	void Scale(std::span<const VecBase2<instanceType>> in, std::span<VecBase2<instanceType>> out, const VecBase2<instanceType>& scale, const ReduceOptions& options = {})
+	{
+		ScaleOffset(in, out, scale, VecBase2<instanceType>(0, 0), options);
+	}
+
+	template <typename instanceType>
+	void Scale(const VecSoA2<instanceType>& in, VecSoA2<instanceType>& out, const VecBase2<instanceType>& scale, const ReduceOptions& options = {})
+	{
+		ScaleOffset(in, out, scale, VecBase2<instanceType>(0, 0), options);
+	}
+
+	// Runs function on every vector in parallel and writes the result to out, no SIMD here so keep
+	// function small enough for the compiler to inline and vectorise itself
+	template <typename instanceType, typename Function>
+	void Transform(std::span<const VecBase2<instanceType>> in, std::span<VecBase2<instanceType>> out, Function function, const ReduceOptions& options = {})
+	{
+		detail::parallelChunks(std::min(in.size(), out.size()), options, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; i++)
+				out[i] = function(in[i]);
+		});
+	}
+
+	template <typename instanceType, typename Function>
+	void Transform(const VecSoA2<instanceType>& in, VecSoA2<instanceType>& out, Function function, const ReduceOptions& options = {})
+	{
+		out.resize(in.size());
+
+		detail::parallelChunks(in.size(), options, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; i++)
+				out.set(i, function(in.at(i)));
+		});
+	}
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <immintrin.h>
+#include <cstddef>
+#include <cstdint>
+
+// The bulk VecBase2 code only uses the wide paths when the compiler is allowed to emit AVX2
+// (/arch:AVX2 or -mavx2), everything else falls back to plain scalar loops
+#if defined(__AVX2__)
+#define VECBASE_AVX2 1
+#else
+#define VECBASE_AVX2 0
+#endif
+
+// Thin wrapper around the intrinsics so the bulk kernels can be written once for float and double
+// enabled is false for every type without a wide path (int, unsigned int, ...)
+template <typename instanceType>
+struct SimdLanes
+{
+	static constexpr bool enabled = false;
+	static constexpr std::size_t width = 1;
+};
+
+#if VECBASE_AVX2
+
+template <>
+struct SimdLanes<float>
+{
+	static constexpr bool enabled = true;
+	static constexpr std::size_t width = 8;
+
+	using Reg = __m256;
+	using IndexReg = __m256i;
+	using IndexType = std::int32_t;
+
+	__forceinline static Reg zero() { return _mm256_setzero_ps(); }
+	__forceinline static Reg set1(float value) { return _mm256_set1_ps(value); }
+	__forceinline static Reg setPair(float x, float y) { return _mm256_setr_ps(x, y, x, y, x, y, x, y); }
+	__forceinline static Reg loadu(const float* data) { return _mm256_loadu_ps(data); }
+	__forceinline static void storeu(float* data, Reg value) { _mm256_storeu_ps(data, value); }
+
+	__forceinline static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+	__forceinline static Reg sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+	__forceinline static Reg mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+	__forceinline static Reg div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+	__forceinline static Reg min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+	__forceinline static Reg max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+
+	// Comparisons give all ones in the lanes where they hold
+	__forceinline static Reg lessThan(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	__forceinline static Reg lessEqual(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	__forceinline static Reg greaterThan(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	__forceinline static Reg greaterEqual(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	__forceinline static Reg notEqual(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+	__forceinline static Reg and_(Reg a, Reg b) { return _mm256_and_ps(a, b); }
+	__forceinline static Reg or_(Reg a, Reg b) { return _mm256_or_ps(a, b); }
+	__forceinline static Reg xor_(Reg a, Reg b) { return _mm256_xor_ps(a, b); }
+	__forceinline static Reg andNot(Reg a, Reg b) { return _mm256_andnot_ps(a, b); }
+	__forceinline static Reg select(Reg mask, Reg ifFalse, Reg ifTrue) { return _mm256_blendv_ps(ifFalse, ifTrue, mask); }
+	__forceinline static int movemask(Reg mask) { return _mm256_movemask_ps(mask); }
+
+	// Splits 8 interleaved x,y pairs into an x and a y register
+	// The shuffle leaves the lanes in the order given by aosOrder()
+	__forceinline static void loadAoS(const float* data, Reg& x, Reg& y)
+	{
+		Reg a = _mm256_loadu_ps(data);
+		Reg b = _mm256_loadu_ps(data + 8);
+		x = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+		y = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+
+	// Exact inverse of loadAoS
+	__forceinline static void storeAoS(float* data, Reg x, Reg y)
+	{
+		_mm256_storeu_ps(data, _mm256_unpacklo_ps(x, y));
+		_mm256_storeu_ps(data + 8, _mm256_unpackhi_ps(x, y));
+	}
+
+	__forceinline static IndexReg aosOrder() { return _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7); }
+	__forceinline static IndexReg soaOrder() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+	__forceinline static IndexReg setIndex(IndexType value) { return _mm256_set1_epi32(value); }
+	__forceinline static IndexReg addIndex(IndexReg index, IndexType amount) { return _mm256_add_epi32(index, _mm256_set1_epi32(amount)); }
+	__forceinline static IndexReg selectIndex(Reg mask, IndexReg ifFalse, IndexReg ifTrue) { return _mm256_blendv_epi8(ifFalse, ifTrue, _mm256_castps_si256(mask)); }
+	__forceinline static void storeIndex(IndexType* data, IndexReg index) { _mm256_storeu_si256((__m256i*)data, index); }
+};
+
+template <>
+struct SimdLanes<double>
+{
+	static constexpr bool enabled = true;
+	static constexpr std::size_t width = 4;
+
+	using Reg = __m256d;
+	using IndexReg = __m256i;
+	using IndexType = std::int64_t;
+
+	__forceinline static Reg zero() { return _mm256_setzero_pd(); }
+	__forceinline static Reg set1(double value) { return _mm256_set1_pd(value); }
+	__forceinline static Reg setPair(double x, double y) { return _mm256_setr_pd(x, y, x, y); }
+	__forceinline static Reg loadu(const double* data) { return _mm256_loadu_pd(data); }
+	__forceinline static void storeu(double* data, Reg value) { _mm256_storeu_pd(data, value); }
+
+	__forceinline static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+	__forceinline static Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+	__forceinline static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+	__forceinline static Reg div(Reg a, Reg b) { return _mm256_div_pd(a, b); }
+	__forceinline static Reg min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+	__forceinline static Reg max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+
+	__forceinline static Reg lessThan(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+	__forceinline static Reg lessEqual(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+	__forceinline static Reg greaterThan(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+	__forceinline static Reg greaterEqual(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+	__forceinline static Reg notEqual(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+	__forceinline static Reg and_(Reg a, Reg b) { return _mm256_and_pd(a, b); }
+	__forceinline static Reg or_(Reg a, Reg b) { return _mm256_or_pd(a, b); }
+	__forceinline static Reg xor_(Reg a, Reg b) { return _mm256_xor_pd(a, b); }
+	__forceinline static Reg andNot(Reg a, Reg b) { return _mm256_andnot_pd(a, b); }
+	__forceinline static Reg select(Reg mask, Reg ifFalse, Reg ifTrue) { return _mm256_blendv_pd(ifFalse, ifTrue, mask); }
+	__forceinline static int movemask(Reg mask) { return _mm256_movemask_pd(mask); }
+
+	// Splits 4 interleaved x,y pairs into an x and a y register, lanes end up in aosOrder()
+	__forceinline static void loadAoS(const double* data, Reg& x, Reg& y)
+	{
+		Reg a = _mm256_loadu_pd(data);
+		Reg b = _mm256_loadu_pd(data + 4);
+		x = _mm256_unpacklo_pd(a, b);
+		y = _mm256_unpackhi_pd(a, b);
+	}
+
+	// Exact inverse of loadAoS
+	__forceinline static void storeAoS(double* data, Reg x, Reg y)
+	{
+		_mm256_storeu_pd(data, _mm256_unpacklo_pd(x, y));
+		_mm256_storeu_pd(data + 4, _mm256_unpackhi_pd(x, y));
+	}
+
+	__forceinline static IndexReg aosOrder() { return _mm256_setr_epi64x(0, 2, 1, 3); }
+	__forceinline static IndexReg soaOrder() { return _mm256_setr_epi64x(0, 1, 2, 3); }
+	__forceinline static IndexReg setIndex(IndexType value) { return _mm256_set1_epi64x(value); }
+	__forceinline static IndexReg addIndex(IndexReg index, IndexType amount) { return _mm256_add_epi64(index, _mm256_set1_epi64x(amount)); }
+	__forceinline static IndexReg selectIndex(Reg mask, IndexReg ifFalse, IndexReg ifTrue) { return _mm256_blendv_epi8(ifFalse, ifTrue, _mm256_castpd_si256(mask)); }
+	__forceinline static void storeIndex(IndexType* data, IndexReg index) { _mm256_storeu_si256((__m256i*)data, index); }
+};
+
+#endif
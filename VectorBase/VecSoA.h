@@ -0,0 +1,94 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <cmath>
+#include <cstddef>
+#include "VecBase.h"
+
+// Structure of arrays storage for VecBase2, all the x's live together and all the y's live together
+// so bulk code can load 8 x's or 8 y's with one SIMD load instead of shuffling interleaved pairs
+template <typename instanceType>
+class VecSoA2
+{
+public:
+	VecSoA2() {};
+
+	explicit VecSoA2(std::size_t count) : x(count), y(count) {};
+
+	explicit VecSoA2(std::span<const VecBase2<instanceType>> vecs)
+	{
+		x.reserve(vecs.size());
+		y.reserve(vecs.size());
+		for (const auto& vec : vecs)
+		{
+			x.push_back(vec.x);
+			y.push_back(vec.y);
+		}
+	}
+
+	__forceinline std::size_t size() const
+	{
+		return x.size();
+	}
+
+	__forceinline bool empty() const
+	{
+		return x.empty();
+	}
+
+	void reserve(std::size_t count)
+	{
+		x.reserve(count);
+		y.reserve(count);
+	}
+
+	void resize(std::size_t count)
+	{
+		x.resize(count);
+		y.resize(count);
+	}
+
+	void clear()
+	{
+		x.clear();
+		y.clear();
+	}
+
+	__forceinline void push_back(const VecBase2<instanceType>& vec)
+	{
+		x.push_back(vec.x);
+		y.push_back(vec.y);
+	}
+
+	__forceinline VecBase2<instanceType> at(std::size_t index) const
+	{
+		return VecBase2<instanceType>(x[index], y[index]);
+	}
+
+	__forceinline void set(std::size_t index, const VecBase2<instanceType>& vec)
+	{
+		x[index] = vec.x;
+		y[index] = vec.y;
+	}
+
+	// Copy back out into the usual array of VecBase2 layout
+	std::vector<VecBase2<instanceType>> toAoS() const
+	{
+		std::vector<VecBase2<instanceType>> out;
+		out.reserve(size());
+		for (std::size_t i = 0; i < size(); i++)
+		{
+			out.emplace_back(x[i], y[i]);
+		}
+		return out;
+	}
+
+public:
+	std::vector<instanceType> x;
+	std::vector<instanceType> y;
+};
+
+typedef VecSoA2<int> IVecSoA2;
+typedef VecSoA2<unsigned int> UVecSoA2;
+typedef VecSoA2<double> DVecSoA2;
+typedef VecSoA2<float> FVecSoA2;
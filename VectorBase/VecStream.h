@@ -0,0 +1,698 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "VecBase.h"
+#include "VecSimd.h"
+
+// Compact binary format for streams of FVec2 / DVec2 frames (snapshots, replays, ...)
+//
+// Every component is quantized to 16 or 24 bits inside a fixed box given per stream. Frames are
+// either key frames (the quantized values packed as little endian 2 or 3 byte integers) or delta
+// frames (each value minus the same value in the previous frame, zigzagged and written as a varint)
+// Frames are split into chunk records of at most chunkSize vectors so neither side ever needs more
+// than one chunk plus the previous frames quantized values in memory
+//
+// Layout, everything little endian
+//   header  : "VS2Q" u8 version, u8 bits, u8 flags, u8 reserved, u32 chunkSize, f64 minX minY maxX maxY
+//   frame   : u8 frameType, varint vectorCount, chunk...
+//   chunk   : varint vectorCount, varint byteCount, payload
+namespace VecStream
+{
+	enum class Quantization : std::uint8_t
+	{
+		Bits16 = 16,
+		Bits24 = 24
+	};
+
+	template <typename instanceType>
+	struct StreamConfig
+	{
+		// Every vector gets clamped into this box before it is quantized
+		VecBase2<instanceType> min = VecBase2<instanceType>(0, 0);
+		VecBase2<instanceType> max = VecBase2<instanceType>(1, 1);
+
+		Quantization bits = Quantization::Bits16;
+
+		// Write frames as the difference from the previous frame whenever the vector count matches
+		bool delta = true;
+
+		// Force a key frame every n frames so a reader can start part way through, 0 means never
+		std::uint32_t keyframeInterval = 0;
+
+		// Most vectors in a single chunk record
+		std::uint32_t chunkSize = 4096;
+	};
+
+	namespace detail
+	{
+		static constexpr std::uint8_t magic[4] = { 'V', 'S', '2', 'Q' };
+		static constexpr std::uint8_t version = 1;
+		static constexpr std::uint8_t deltaFlag = 1;
+
+		// Readers reject frames claiming more vectors than this as malformed
+		static constexpr std::uint64_t maxFrameVectors = std::uint64_t(1) << 32;
+
+		// Largest chunkSize a stream can use, writers clamp to it and readers reject headers above it
+		static constexpr std::uint32_t maxChunkSize = 1 << 20;
+
+		// Chunk payloads are read in pieces of at most this many bytes so a lying byte count cant allocate ahead of the data
+		static constexpr std::size_t readPieceBytes = 64 * 1024;
+
+		enum FrameType : std::uint8_t
+		{
+			KeyFrame = 0,
+			DeltaFrame = 1
+		};
+
+		__forceinline std::uint32_t zigzag(std::int32_t value)
+		{
+			return ((std::uint32_t)value << 1) ^ (std::uint32_t)(value >> 31);
+		}
+
+		__forceinline std::int32_t unzigzag(std::uint32_t value)
+		{
+			return (std::int32_t)(value >> 1) ^ -(std::int32_t)(value & 1);
+		}
+
+		__forceinline void appendVarint(std::vector<std::uint8_t>& out, std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.push_back((std::uint8_t)(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back((std::uint8_t)value);
+		}
+
+		__forceinline bool parseVarint(const std::uint8_t*& cursor, const std::uint8_t* end, std::uint64_t& value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 64 && cursor != end; shift += 7)
+			{
+				std::uint8_t byte = *cursor++;
+				value |= (std::uint64_t)(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+					return true;
+			}
+			return false;
+		}
+
+		inline void writeVarint(std::ostream& stream, std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				stream.put((char)(value | 0x80));
+				value >>= 7;
+			}
+			stream.put((char)value);
+		}
+
+		inline bool readVarint(std::istream& stream, std::uint64_t& value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				int byte = stream.get();
+				if (byte == std::char_traits<char>::eof())
+					return false;
+
+				value |= (std::uint64_t)(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+					return true;
+			}
+			return false;
+		}
+
+		inline void writeU32(std::ostream& stream, std::uint32_t value)
+		{
+			for (int i = 0; i < 4; i++)
+				stream.put((char)(value >> (i * 8)));
+		}
+
+		inline bool readU32(std::istream& stream, std::uint32_t& value)
+		{
+			std::uint8_t bytes[4];
+			if (!stream.read(reinterpret_cast<char*>(bytes), 4))
+				return false;
+
+			value = 0;
+			for (int i = 0; i < 4; i++)
+				value |= (std::uint32_t)bytes[i] << (i * 8);
+			return true;
+		}
+
+		inline void writeF64(std::ostream& stream, double value)
+		{
+			std::uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			for (int i = 0; i < 8; i++)
+				stream.put((char)(bits >> (i * 8)));
+		}
+
+		inline bool readF64(std::istream& stream, double& value)
+		{
+			std::uint8_t bytes[8];
+			if (!stream.read(reinterpret_cast<char*>(bytes), 8))
+				return false;
+
+			std::uint64_t bits = 0;
+			for (int i = 0; i < 8; i++)
+				bits |= (std::uint64_t)bytes[i] << (i * 8);
+			std::memcpy(&value, &bits, sizeof(value));
+			return true;
+		}
+
+		// Maps components in [min, max] onto [0, maxQ] and back
+		// Works on flat interleaved x,y arrays so the SIMD paths can use a repeating x,y register
+		template <typename instanceType>
+		class Quantizer
+		{
+		public:
+			Quantizer() {};
+
+			Quantizer(const StreamConfig<instanceType>& config)
+			{
+				maxQ = (1u << (std::uint32_t)config.bits) - 1;
+				minX = config.min.x;
+				minY = config.min.y;
+
+				instanceType rangeX = config.max.x - config.min.x;
+				instanceType rangeY = config.max.y - config.min.y;
+				scaleX = rangeX > 0 ? (instanceType)maxQ / rangeX : 0;
+				scaleY = rangeY > 0 ? (instanceType)maxQ / rangeY : 0;
+				stepX = rangeX > 0 ? rangeX / (instanceType)maxQ : 0;
+				stepY = rangeY > 0 ? rangeY / (instanceType)maxQ : 0;
+			}
+
+			// components must be even, out gets one value per component
+			void quantize(const instanceType* in, std::uint32_t* out, std::size_t components) const
+			{
+				std::size_t i = 0;
+
+#if VECBASE_AVX2
+				if constexpr (std::is_same<instanceType, float>::value)
+				{
+					__m256 minReg = _mm256_setr_ps(minX, minY, minX, minY, minX, minY, minX, minY);
+					__m256 scaleReg = _mm256_setr_ps(scaleX, scaleY, scaleX, scaleY, scaleX, scaleY, scaleX, scaleY);
+					__m256 zeroReg = _mm256_setzero_ps();
+					__m256 maxReg = _mm256_set1_ps((float)maxQ);
+					for (; i + 8 <= components; i += 8)
+					{
+						__m256 value = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(in + i), minReg), scaleReg);
+						// max_ps returns the second operand for NaN so NaNs land on 0
+						value = _mm256_min_ps(_mm256_max_ps(value, zeroReg), maxReg);
+						_mm256_storeu_si256((__m256i*)(out + i), _mm256_cvtps_epi32(value));
+					}
+				}
+				else if constexpr (std::is_same<instanceType, double>::value)
+				{
+					__m256d minReg = _mm256_setr_pd(minX, minY, minX, minY);
+					__m256d scaleReg = _mm256_setr_pd(scaleX, scaleY, scaleX, scaleY);
+					__m256d zeroReg = _mm256_setzero_pd();
+					__m256d maxReg = _mm256_set1_pd((double)maxQ);
+					for (; i + 4 <= components; i += 4)
+					{
+						__m256d value = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(in + i), minReg), scaleReg);
+						value = _mm256_min_pd(_mm256_max_pd(value, zeroReg), maxReg);
+						_mm_storeu_si128((__m128i*)(out + i), _mm256_cvtpd_epi32(value));
+					}
+				}
+#endif
+
+				for (; i < components; i += 2)
+				{
+					out[i] = quantizeOne(in[i], minX, scaleX);
+					out[i + 1] = quantizeOne(in[i + 1], minY, scaleY);
+				}
+			}
+
+			void dequantize(const std::uint32_t* in, instanceType* out, std::size_t components) const
+			{
+				std::size_t i = 0;
+
+#if VECBASE_AVX2
+				if constexpr (std::is_same<instanceType, float>::value)
+				{
+					__m256 minReg = _mm256_setr_ps(minX, minY, minX, minY, minX, minY, minX, minY);
+					__m256 stepReg = _mm256_setr_ps(stepX, stepY, stepX, stepY, stepX, stepY, stepX, stepY);
+					for (; i + 8 <= components; i += 8)
+					{
+						// Values are at most 24 bits so the signed conversion is exact
+						__m256 value = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(in + i)));
+						_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(value, stepReg), minReg));
+					}
+				}
+				else if constexpr (std::is_same<instanceType, double>::value)
+				{
+					__m256d minReg = _mm256_setr_pd(minX, minY, minX, minY);
+					__m256d stepReg = _mm256_setr_pd(stepX, stepY, stepX, stepY);
+					for (; i + 4 <= components; i += 4)
+					{
+						__m256d value = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(in + i)));
+						_mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(value, stepReg), minReg));
+					}
+				}
+#endif
+
+				for (; i < components; i += 2)
+				{
+					out[i] = (instanceType)in[i] * stepX + minX;
+					out[i + 1] = (instanceType)in[i + 1] * stepY + minY;
+				}
+			}
+
+		private:
+			// Rounds to nearest even like the SIMD conversion so both paths write the same bytes
+			__forceinline std::uint32_t quantizeOne(instanceType value, instanceType min, instanceType scale) const
+			{
+				instanceType scaled = (value - min) * scale;
+				if (!(scaled > 0))
+					return 0;
+				if (scaled >= (instanceType)maxQ)
+					return maxQ;
+				return (std::uint32_t)std::nearbyint(scaled);
+			}
+
+		private:
+			std::uint32_t maxQ = 0;
+			instanceType minX = 0, minY = 0;
+			instanceType scaleX = 0, scaleY = 0;
+			instanceType stepX = 0, stepY = 0;
+		};
+
+		// out[i] = zigzag(current[i] - previous[i]), then previous[i] = current[i]
+		inline void deltaEncode(const std::uint32_t* current, std::uint32_t* previous, std::uint32_t* out, std::size_t count)
+		{
+			std::size_t i = 0;
+
+#if VECBASE_AVX2
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i now = _mm256_loadu_si256((const __m256i*)(current + i));
+				__m256i diff = _mm256_sub_epi32(now, _mm256_loadu_si256((const __m256i*)(previous + i)));
+				__m256i zig = _mm256_xor_si256(_mm256_slli_epi32(diff, 1), _mm256_srai_epi32(diff, 31));
+				_mm256_storeu_si256((__m256i*)(out + i), zig);
+				_mm256_storeu_si256((__m256i*)(previous + i), now);
+			}
+#endif
+
+			for (; i < count; i++)
+			{
+				out[i] = zigzag((std::int32_t)(current[i] - previous[i]));
+				previous[i] = current[i];
+			}
+		}
+
+		// Inverse of deltaEncode, zigzagged is turned into the quantized values in place
+		inline void deltaDecode(std::uint32_t* zigzagged, std::uint32_t* previous, std::size_t count)
+		{
+			std::size_t i = 0;
+
+#if VECBASE_AVX2
+			__m256i one = _mm256_set1_epi32(1);
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i zig = _mm256_loadu_si256((const __m256i*)(zigzagged + i));
+				__m256i diff = _mm256_xor_si256(_mm256_srli_epi32(zig, 1), _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(zig, one)));
+				__m256i now = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(previous + i)), diff);
+				_mm256_storeu_si256((__m256i*)(zigzagged + i), now);
+				_mm256_storeu_si256((__m256i*)(previous + i), now);
+			}
+#endif
+
+			for (; i < count; i++)
+			{
+				std::uint32_t now = previous[i] + (std::uint32_t)unzigzag(zigzagged[i]);
+				zigzagged[i] = now;
+				previous[i] = now;
+			}
+		}
+	}
+
+	template <typename instanceType>
+	class VecStreamWriter
+	{
+		static_assert(std::is_floating_point<instanceType>::value, "VecStream only handles FVec2 and DVec2");
+
+	public:
+		// Writes the stream header straight away
+		VecStreamWriter(std::ostream& stream, const StreamConfig<instanceType>& config) : _stream(stream), _config(config), _quantizer(config)
+		{
+			if (_config.chunkSize == 0)
+				_config.chunkSize = 4096;
+			_config.chunkSize = std::min(_config.chunkSize, detail::maxChunkSize);
+
+			_stream.write(reinterpret_cast<const char*>(detail::magic), 4);
+			_stream.put((char)detail::version);
+			_stream.put((char)_config.bits);
+			_stream.put((char)(_config.delta ? detail::deltaFlag : 0));
+			_stream.put(0);
+			detail::writeU32(_stream, _config.chunkSize);
+			detail::writeF64(_stream, (double)_config.min.x);
+			detail::writeF64(_stream, (double)_config.min.y);
+			detail::writeF64(_stream, (double)_config.max.x);
+			detail::writeF64(_stream, (double)_config.max.y);
+		}
+
+		// False once the stream has failed or a frame was ended short, nothing written after that can be read back
+		__forceinline bool good() const
+		{
+			return !_failed && _stream.good();
+		}
+
+		// Writes a whole frame, same as beginFrame + writeChunk + endFrame
+		bool writeFrame(std::span<const VecBase2<instanceType>> vecs)
+		{
+			if (!beginFrame(vecs.size()))
+				return false;
+			writeChunk(vecs);
+			return endFrame();
+		}
+
+		// Starts a frame of count vectors which then get fed in with writeChunk in as many pieces as
+		// needed, so a frame never has to be fully built in memory
+		// Returns false without writing anything if a frame is already open, the writer is not good()
+		// or count is more than a reader accepts
+		bool beginFrame(std::size_t count)
+		{
+			if (_frameOpen || !good() || count > detail::maxFrameVectors)
+				return false;
+
+			bool canDelta = _config.delta && _frameIndex != 0 && count * 2 == _previous.size();
+			bool forceKey = _config.keyframeInterval != 0 && _frameIndex % _config.keyframeInterval == 0;
+			_frameType = (canDelta && !forceKey) ? detail::DeltaFrame : detail::KeyFrame;
+
+			if (_config.delta)
+				_previous.resize(count * 2);
+
+			_frameCount = count;
+			_frameWritten = 0;
+			_frameOpen = true;
+
+			_stream.put((char)_frameType);
+			detail::writeVarint(_stream, count);
+			return true;
+		}
+
+		// Vectors past the count given to beginFrame are ignored
+		void writeChunk(std::span<const VecBase2<instanceType>> vecs)
+		{
+			if (!_frameOpen)
+				return;
+
+			const instanceType* data = reinterpret_cast<const instanceType*>(vecs.data());
+			std::size_t total = std::min(vecs.size(), _frameCount - _frameWritten);
+
+			for (std::size_t done = 0; done < total;)
+			{
+				std::size_t count = std::min<std::size_t>(total - done, _config.chunkSize);
+				writeRecord(data + done * 2, count);
+				done += count;
+			}
+		}
+
+		// Returns false if fewer vectors than promised to beginFrame were written or the stream failed
+		// A short frame leaves the stream unreadable from here on so the writer stops being good() and refuses more frames
+		bool endFrame()
+		{
+			if (!_frameOpen)
+				return false;
+
+			_frameOpen = false;
+			_frameIndex++;
+			if (_frameWritten != _frameCount)
+				_failed = true;
+			return good();
+		}
+
+	private:
+		void writeRecord(const instanceType* data, std::size_t count)
+		{
+			std::size_t components = count * 2;
+			_quantized.resize(components);
+			_quantizer.quantize(data, _quantized.data(), components);
+
+			_bytes.clear();
+			if (_frameType == detail::KeyFrame)
+			{
+				if (_config.delta)
+					std::memcpy(_previous.data() + _frameWritten * 2, _quantized.data(), components * sizeof(std::uint32_t));
+
+				int byteWidth = (int)_config.bits / 8;
+				_bytes.resize(components * byteWidth);
+				std::uint8_t* out = _bytes.data();
+				for (std::size_t i = 0; i < components; i++)
+				{
+					for (int b = 0; b < byteWidth; b++)
+						*out++ = (std::uint8_t)(_quantized[i] >> (b * 8));
+				}
+			}
+			else
+			{
+				_zigzagged.resize(components);
+				detail::deltaEncode(_quantized.data(), _previous.data() + _frameWritten * 2, _zigzagged.data(), components);
+
+				for (std::size_t i = 0; i < components; i++)
+					detail::appendVarint(_bytes, _zigzagged[i]);
+			}
+
+			detail::writeVarint(_stream, count);
+			detail::writeVarint(_stream, _bytes.size());
+			_stream.write(reinterpret_cast<const char*>(_bytes.data()), _bytes.size());
+			_frameWritten += count;
+		}
+
+	private:
+		std::ostream& _stream;
+		StreamConfig<instanceType> _config;
+		detail::Quantizer<instanceType> _quantizer;
+
+		std::size_t _frameIndex = 0;
+		std::size_t _frameCount = 0;
+		std::size_t _frameWritten = 0;
+		detail::FrameType _frameType = detail::KeyFrame;
+		bool _frameOpen = false;
+		bool _failed = false;
+
+		// Quantized values of the last frame, only kept when delta is on
+		std::vector<std::uint32_t> _previous;
+
+		// Scratch space for one chunk record
+		std::vector<std::uint32_t> _quantized;
+		std::vector<std::uint32_t> _zigzagged;
+		std::vector<std::uint8_t> _bytes;
+	};
+
+	template <typename instanceType>
+	class VecStreamReader
+	{
+		static_assert(std::is_floating_point<instanceType>::value, "VecStream only handles FVec2 and DVec2");
+
+	public:
+		// Reads and checks the stream header straight away, see good()
+		VecStreamReader(std::istream& stream) : _stream(stream)
+		{
+			_valid = readHeader();
+			if (_valid)
+				_quantizer = detail::Quantizer<instanceType>(_config);
+		}
+
+		// False if the header was bad or a frame failed to decode
+		__forceinline bool good() const
+		{
+			return _valid;
+		}
+
+		__forceinline const StreamConfig<instanceType>& config() const
+		{
+			return _config;
+		}
+
+		// Decodes the next frame one chunk record at a time, calling
+		// onChunk(std::span<const VecBase2<T>> vecs, std::size_t firstIndex) for each of them
+		// Returns false at the end of the stream or if the frame is malformed (good() tells which)
+		template <typename ChunkFn>
+		bool readFrame(ChunkFn&& onChunk)
+		{
+			if (!_valid)
+				return false;
+
+			int frameType = _stream.get();
+			if (frameType == std::char_traits<char>::eof())
+				return false;
+
+			std::uint64_t count;
+			if (!detail::readVarint(_stream, count))
+				return fail();
+
+			// count comes straight off the stream so make sure count * 2 cant wrap before using it
+			if (count > detail::maxFrameVectors || count > SIZE_MAX / 2)
+				return fail();
+
+			if (frameType == detail::DeltaFrame)
+			{
+				if (!_config.delta || _previous.size() != count * 2)
+					return fail();
+			}
+			else if (frameType == detail::KeyFrame)
+			{
+				// Grown chunk by chunk below so a lying count cant make us allocate ahead of the data
+				_previous.clear();
+			}
+			else
+			{
+				return fail();
+			}
+
+			for (std::size_t done = 0; done < count;)
+			{
+				std::uint64_t chunkCount, byteCount;
+				if (!detail::readVarint(_stream, chunkCount) || !detail::readVarint(_stream, byteCount))
+					return fail();
+				if (chunkCount == 0 || chunkCount > _config.chunkSize || chunkCount > count - done)
+					return fail();
+
+				// A varint of a 32 bit value is never longer than 5 bytes
+				std::size_t components = chunkCount * 2;
+				if (byteCount > components * 5)
+					return fail();
+
+				_bytes.clear();
+				while (_bytes.size() < byteCount)
+				{
+					std::size_t at = _bytes.size();
+					std::size_t piece = std::min<std::size_t>(byteCount - at, detail::readPieceBytes);
+					_bytes.resize(at + piece);
+					if (!_stream.read(reinterpret_cast<char*>(_bytes.data() + at), piece))
+						return fail();
+				}
+
+				_quantized.resize(components);
+				if (frameType == detail::KeyFrame)
+				{
+					if (_config.delta)
+						_previous.resize((done + chunkCount) * 2);
+					if (!unpackKey(components, done))
+						return fail();
+				}
+				else
+				{
+					if (!unpackDelta(components, done))
+						return fail();
+				}
+
+				_vecs.resize(chunkCount);
+				_quantizer.dequantize(_quantized.data(), reinterpret_cast<instanceType*>(_vecs.data()), components);
+				onChunk(std::span<const VecBase2<instanceType>>(_vecs.data(), chunkCount), done);
+				done += chunkCount;
+			}
+			return true;
+		}
+
+		// Decodes the next frame into out, which is resized to fit
+		bool readFrame(std::vector<VecBase2<instanceType>>& out)
+		{
+			out.clear();
+			return readFrame([&out](std::span<const VecBase2<instanceType>> vecs, std::size_t)
+			{
+				out.insert(out.end(), vecs.begin(), vecs.end());
+			});
+		}
+
+	private:
+		bool readHeader()
+		{
+			std::uint8_t head[8];
+			if (!_stream.read(reinterpret_cast<char*>(head), 8))
+				return false;
+			if (std::memcmp(head, detail::magic, 4) != 0 || head[4] != detail::version)
+				return false;
+			if (head[5] != (std::uint8_t)Quantization::Bits16 && head[5] != (std::uint8_t)Quantization::Bits24)
+				return false;
+
+			_config.bits = (Quantization)head[5];
+			_config.delta = (head[6] & detail::deltaFlag) != 0;
+
+			double minX, minY, maxX, maxY;
+			if (!detail::readU32(_stream, _config.chunkSize) || _config.chunkSize == 0 || _config.chunkSize > detail::maxChunkSize)
+				return false;
+			if (!detail::readF64(_stream, minX) || !detail::readF64(_stream, minY) || !detail::readF64(_stream, maxX) || !detail::readF64(_stream, maxY))
+				return false;
+
+			_config.min = VecBase2<instanceType>((instanceType)minX, (instanceType)minY);
+			_config.max = VecBase2<instanceType>((instanceType)maxX, (instanceType)maxY);
+			return true;
+		}
+
+		bool unpackKey(std::size_t components, std::size_t firstVec)
+		{
+			int byteWidth = (int)_config.bits / 8;
+			if (_bytes.size() != components * byteWidth)
+				return false;
+
+			const std::uint8_t* in = _bytes.data();
+			for (std::size_t i = 0; i < components; i++)
+			{
+				std::uint32_t value = 0;
+				for (int b = 0; b < byteWidth; b++)
+					value |= (std::uint32_t)*in++ << (b * 8);
+				_quantized[i] = value;
+			}
+
+			if (_config.delta)
+				std::memcpy(_previous.data() + firstVec * 2, _quantized.data(), components * sizeof(std::uint32_t));
+			return true;
+		}
+
+		bool unpackDelta(std::size_t components, std::size_t firstVec)
+		{
+			const std::uint8_t* cursor = _bytes.data();
+			const std::uint8_t* end = cursor + _bytes.size();
+			for (std::size_t i = 0; i < components; i++)
+			{
+				std::uint64_t value;
+				if (!detail::parseVarint(cursor, end, value) || value > UINT32_MAX)
+					return false;
+				_quantized[i] = (std::uint32_t)value;
+			}
+			if (cursor != end)
+				return false;
+
+			detail::deltaDecode(_quantized.data(), _previous.data() + firstVec * 2, components);
+			return true;
+		}
+
+		__forceinline bool fail()
+		{
+			_valid = false;
+			return false;
+		}
+
+	private:
+		std::istream& _stream;
+		StreamConfig<instanceType> _config;
+		detail::Quantizer<instanceType> _quantizer;
+		bool _valid = false;
+
+		// Quantized values of the last frame, only kept when delta is on
+		std::vector<std::uint32_t> _previous;
+
+		// Scratch space for one chunk record
+		std::vector<std::uint8_t> _bytes;
+		std::vector<std::uint32_t> _quantized;
+		std::vector<VecBase2<instanceType>> _vecs;
+	};
+
+	typedef VecStreamWriter<float> FVec2StreamWriter;
+	typedef VecStreamWriter<double> DVec2StreamWriter;
+	typedef VecStreamReader<float> FVec2StreamReader;
+	typedef VecStreamReader<double> DVec2StreamReader;
+}